@@ -1,9 +1,22 @@
 #include "DriverInterface.h"
 #include "DriverTypes.h"
 #include <iostream>
+#include <cstdint>
+#include <cstring>
 using namespace std;
 static bool initialized = false;
 static DriverState currentState = DRIVER_STATE_UNINITIALIZED;
+static uint16_t nextSample = 0;
+
+//fills whole 12-bit samples, returns the bytes written
+static size_t sampleChannels(void* buffer, size_t size) {
+    size_t samples = size / sizeof(uint16_t);
+    for (size_t i = 0; i < samples; i++) {
+        uint16_t value = nextSample++ & 0x0FFF;
+        memcpy(static_cast<uint8_t*>(buffer) + i * sizeof(uint16_t), &value, sizeof(value));
+    }
+    return samples * sizeof(uint16_t);
+}
 
 extern "C" {
     const char* driverName() {
@@ -48,7 +61,7 @@ extern "C" {
         return initialized ? DRIVER_STATUS_SUCCESS : DRIVER_STATUS_NOT_READY;
     }
 
-    DriverStatus driverRead(void* buffer, size_t size) {
+    int driverRead(void* buffer, size_t size) {
         if (!initialized) return DRIVER_STATUS_NOT_READY;
         
         if (size == 2) {
@@ -56,7 +69,7 @@ extern "C" {
         } else {
             cout << "[ADC] Reading " << (size / 2) << " channels" << endl;
         }
-        return DRIVER_STATUS_SUCCESS;
+        return static_cast<int>(sampleChannels(buffer, size));
     }
 
     DriverStatus driverWrite(const void* buffer, size_t size) {
@@ -65,6 +78,23 @@ extern "C" {
         return DRIVER_STATUS_SUCCESS;
     }
 
+    DriverStatus driverReadBatch(DriverIoDescriptor* descriptors, size_t count) {
+        if (!initialized) return DRIVER_STATUS_NOT_READY;
+
+        size_t totalSamples = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!descriptors[i].buffer || descriptors[i].size < sizeof(uint16_t)) {
+                descriptors[i].result = DRIVER_STATUS_INVALID_PARAM;
+                continue;
+            }
+            size_t bytes = sampleChannels(descriptors[i].buffer, descriptors[i].size);
+            descriptors[i].result = static_cast<int>(bytes);
+            totalSamples += bytes / sizeof(uint16_t);
+        }
+        cout << "[ADC] Batch read " << count << " buffers (" << totalSamples << " samples)" << endl;
+        return DRIVER_STATUS_SUCCESS;
+    }
+
     DriverStatus driverConfigure(int parameter, int value) {
         if (!initialized) return DRIVER_STATUS_NOT_READY;
         
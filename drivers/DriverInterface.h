@@ -12,9 +12,39 @@ extern "C"{
     DriverType driverGetType();
     DriverStatus driverGetStatus();
 
-    DriverStatus driverRead(void* buffer, size_t size);
+    /* reads return the bytes placed in buffer (0 when nothing is available) or a
+       negative DRIVER_STATUS_* code; writes return DRIVER_STATUS_SUCCESS once the
+       whole buffer is taken */
+    int driverRead(void* buffer, size_t size);
     DriverStatus driverWrite(const void* buffer, size_t size);
     DriverStatus driverConfigure(int parameter, int value);
-    
+
+    /* ABI v2, optional. A driver that exports driverAbiVersion() >= 2 backs
+       driverInstanceCount() devices from one binary; the v1 calls above keep
+       working and act on instance 0 */
+    int driverAbiVersion();
+    int driverInstanceCount();
+    DriverInstance* driverOpenInstance(int index);
+    void driverCloseInstance(DriverInstance* instance);
+    int driverInstanceRead(DriverInstance* instance, void* buffer, size_t size);
+    DriverStatus driverInstanceWrite(DriverInstance* instance, const void* buffer, size_t size);
+    DriverStatus driverInstanceConfigure(DriverInstance* instance, int parameter, int value);
+
+    /* Batch calls, optional and independent of the ABI version. One call moves every
+       descriptor; descriptors are independent and each gets its own result. Return
+       DRIVER_STATUS_SUCCESS once all results are set, anything else fails the whole batch */
+    DriverStatus driverReadBatch(DriverIoDescriptor* descriptors, size_t count);
+    DriverStatus driverWriteBatch(DriverIoDescriptor* descriptors, size_t count);
+
+    /* Per-instance batch calls for v2 drivers, same contract as above. Drivers that
+       advertise DRIVER_CAP_DMA should export these, the DMA controller hands them
+       whole descriptor bursts */
+    DriverStatus driverInstanceReadBatch(DriverInstance* instance, DriverIoDescriptor* descriptors, size_t count);
+    DriverStatus driverInstanceWriteBatch(DriverInstance* instance, DriverIoDescriptor* descriptors, size_t count);
+
+    /* Interrupts, optional. Called once after driverInit with the function that raises the
+       driver's IRQ, and with (NULL, NULL) before the driver is unloaded. raise never blocks
+       and may be called from any thread, including from inside the driver's own calls */
+    void driverAttachInterrupt(DriverIrqRaise raise, void* context);
 }
 #endif
\ No newline at end of file
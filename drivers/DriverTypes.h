@@ -1,6 +1,7 @@
 #ifndef DRIVER_TYPES_H
 #define DRIVER_TYPES_H
 #include <stddef.h>
+#include <stdint.h>
 typedef enum {
     DRIVER_TYPE_UART = 1,
     DRIVER_TYPE_I2C = 2,
@@ -35,4 +36,20 @@ typedef enum{
     DRIVER_STATE_ERROR = 3,
 } DriverState;
 
+#define DRIVER_ABI_VERSION_1 1
+#define DRIVER_ABI_VERSION_2 2
+
+/* per-instance state of a v2 driver, opaque to the kernel */
+typedef struct DriverInstance DriverInstance;
+
+/* one buffer of a batched transfer, the driver sets result to bytes moved or a DRIVER_STATUS_* code */
+typedef struct {
+    void* buffer;
+    size_t size;
+    int result;
+} DriverIoDescriptor;
+
+/* kernel function a driver calls to raise its IRQ, context is the value it was handed with it */
+typedef void (*DriverIrqRaise)(void* context, uint32_t data);
+
 #endif
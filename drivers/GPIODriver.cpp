@@ -1,9 +1,51 @@
 #include "DriverInterface.h"
 #include "DriverTypes.h"
 #include <iostream>
+#include <atomic>
+#include <cstdint>
 using namespace std;
+static const size_t GPIO_PINS = 32;
 static bool initialized = false;
 static DriverState currentState = DRIVER_STATE_UNINITIALIZED;
+//one byte per pin, a buffer maps onto consecutive pins starting at 0
+static uint8_t pinStates[GPIO_PINS];
+
+//edge interrupts: bit 0 rising, bit 1 falling; the raised data is the pin, plus 0x100 for a high level
+static const int GPIO_IRQ_RISING = 1;
+static const int GPIO_IRQ_FALLING = 2;
+//set by the loader and driverConfigure while I/O threads are writing pins, hence atomic
+static atomic<int> interruptMode(0);
+static atomic<DriverIrqRaise> raiseIrq(nullptr);
+static atomic<void*> irqContext(nullptr);
+
+static size_t readPins(void* buffer, size_t size) {
+    size_t pins = size < GPIO_PINS ? size : GPIO_PINS;
+    for (size_t i = 0; i < pins; i++) {
+        static_cast<uint8_t*>(buffer)[i] = pinStates[i];
+    }
+    return pins;
+}
+
+static size_t writePins(const void* buffer, size_t size) {
+    size_t pins = size < GPIO_PINS ? size : GPIO_PINS;
+    for (size_t i = 0; i < pins; i++) {
+        uint8_t level = static_cast<const uint8_t*>(buffer)[i] ? 1 : 0;
+        if (level == pinStates[i]) {
+            continue;
+        }
+        pinStates[i] = level;
+        int edge = level ? GPIO_IRQ_RISING : GPIO_IRQ_FALLING;
+        if (!(interruptMode.load(memory_order_relaxed) & edge)) {
+            continue;
+        }
+        DriverIrqRaise raise = raiseIrq.load(memory_order_acquire);
+        void* context = irqContext.load(memory_order_acquire);
+        if (raise && context) {
+            raise(context, static_cast<uint32_t>(i) | (level ? 0x100u : 0u));
+        }
+    }
+    return pins;
+}
 
 extern "C" {
     const char* driverName() {
@@ -49,7 +91,7 @@ extern "C" {
         return initialized ? DRIVER_STATUS_SUCCESS : DRIVER_STATUS_NOT_READY;
     }
 
-    DriverStatus driverRead(void* buffer, size_t size) {
+    int driverRead(void* buffer, size_t size) {
         if (!initialized) return DRIVER_STATUS_NOT_READY;
         
         if (size == 1) {
@@ -57,7 +99,7 @@ extern "C" {
         } else {
             cout << "[GPIO] Reading " << size << " pin states" << endl;
         }
-        return DRIVER_STATUS_SUCCESS;
+        return static_cast<int>(readPins(buffer, size));
     }
 
     DriverStatus driverWrite(const void* buffer, size_t size) {
@@ -68,6 +110,34 @@ extern "C" {
         } else {
             cout << "[GPIO] Setting " << size << " pin states" << endl;
         }
+        writePins(buffer, size);
+        return DRIVER_STATUS_SUCCESS;
+    }
+
+    DriverStatus driverReadBatch(DriverIoDescriptor* descriptors, size_t count) {
+        if (!initialized) return DRIVER_STATUS_NOT_READY;
+        for (size_t i = 0; i < count; i++) {
+            if (!descriptors[i].buffer) {
+                descriptors[i].result = DRIVER_STATUS_INVALID_PARAM;
+                continue;
+            }
+            descriptors[i].result = static_cast<int>(readPins(descriptors[i].buffer, descriptors[i].size));
+        }
+        cout << "[GPIO] Batch read " << count << " pin snapshots" << endl;
+        return DRIVER_STATUS_SUCCESS;
+    }
+
+    //bit-banging: each descriptor is one step of the sequence, applied in order
+    DriverStatus driverWriteBatch(DriverIoDescriptor* descriptors, size_t count) {
+        if (!initialized) return DRIVER_STATUS_NOT_READY;
+        for (size_t i = 0; i < count; i++) {
+            if (!descriptors[i].buffer) {
+                descriptors[i].result = DRIVER_STATUS_INVALID_PARAM;
+                continue;
+            }
+            descriptors[i].result = static_cast<int>(writePins(descriptors[i].buffer, descriptors[i].size));
+        }
+        cout << "[GPIO] Batch applied " << count << " pin updates" << endl;
         return DRIVER_STATUS_SUCCESS;
     }
 
@@ -83,6 +153,7 @@ extern "C" {
                 cout << "[GPIO] Setting pull resistor: " << value << endl;
                 break;
             case 3:
+                interruptMode.store(value & (GPIO_IRQ_RISING | GPIO_IRQ_FALLING), memory_order_relaxed);
                 cout << "[GPIO] Setting interrupt mode: " << value << endl;
                 break;
             default:
@@ -92,4 +163,18 @@ extern "C" {
         }
         return DRIVER_STATUS_SUCCESS;
     }
+
+    void driverAttachInterrupt(DriverIrqRaise raise, void* context) {
+        //context goes in before the function and comes out after it, so a raise that finds the function
+        //also finds its context (or sees null and skips)
+        if (raise) {
+            irqContext.store(context, memory_order_release);
+            raiseIrq.store(raise, memory_order_release);
+        }
+        else{
+            raiseIrq.store(nullptr, memory_order_release);
+            irqContext.store(nullptr, memory_order_release);
+        }
+        cout << "[GPIO] Interrupt line " << (raise ? "attached" : "detached") << endl;
+    }
 }
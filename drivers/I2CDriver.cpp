@@ -47,10 +47,11 @@ extern "C" {
         return initialized ? DRIVER_STATUS_SUCCESS : DRIVER_STATUS_NOT_READY;
     }
 
-    DriverStatus driverRead(void* buffer, size_t size) {
+    //no slave is simulated on the bus, so a read always comes back empty
+    int driverRead(void* buffer, size_t size) {
         if (!initialized) return DRIVER_STATUS_NOT_READY;
         cout << "[I2C] Reading " << size << " bytes from slave" << endl;
-        return DRIVER_STATUS_SUCCESS;
+        return 0;
     }
 
     DriverStatus driverWrite(const void* buffer, size_t size) {
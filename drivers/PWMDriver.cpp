@@ -1,9 +1,33 @@
 #include "DriverInterface.h"
 #include "DriverTypes.h"
 #include <iostream>
+#include <cstdint>
+#include <cstring>
 using namespace std;
+static const size_t PWM_CHANNELS = 16;
 static bool initialized = false;
 static DriverState currentState = DRIVER_STATE_UNINITIALIZED;
+//12-bit duty cycle per channel, a buffer maps onto consecutive channels starting at 0
+static uint16_t dutyCycles[PWM_CHANNELS];
+
+//copies whole channels between the buffer and dutyCycles, returns the bytes moved
+static size_t transferDutyCycles(void* buffer, size_t size, bool writing) {
+    size_t channels = size / sizeof(uint16_t);
+    if (channels > PWM_CHANNELS) {
+        channels = PWM_CHANNELS;
+    }
+    for (size_t i = 0; i < channels; i++) {
+        uint8_t* slot = static_cast<uint8_t*>(buffer) + i * sizeof(uint16_t);
+        if (writing) {
+            uint16_t value;
+            memcpy(&value, slot, sizeof(value));
+            dutyCycles[i] = value & 0x0FFF;
+        } else {
+            memcpy(slot, &dutyCycles[i], sizeof(uint16_t));
+        }
+    }
+    return channels * sizeof(uint16_t);
+}
 
 extern "C" {
     const char* driverName() {
@@ -48,10 +72,10 @@ extern "C" {
         return initialized ? DRIVER_STATUS_SUCCESS : DRIVER_STATUS_NOT_READY;
     }
 
-    DriverStatus driverRead(void* buffer, size_t size) {
+    int driverRead(void* buffer, size_t size) {
         if (!initialized) return DRIVER_STATUS_NOT_READY;
         cout << "[PWM] Reading current duty cycle values" << endl;
-        return DRIVER_STATUS_SUCCESS;
+        return static_cast<int>(transferDutyCycles(buffer, size, false));
     }
 
     DriverStatus driverWrite(const void* buffer, size_t size) {
@@ -63,6 +87,7 @@ extern "C" {
             cout << "[PWM] Setting duty cycles for " << (size / 2) 
                       << " channels" << endl;
         }
+        transferDutyCycles(const_cast<void*>(buffer), size, true);
         return DRIVER_STATUS_SUCCESS;
     }
 
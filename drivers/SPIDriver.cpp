@@ -1,23 +1,130 @@
 #include "DriverInterface.h"
 #include "DriverTypes.h"
 #include <iostream>
+#include <cstdint>
+#include <cstring>
 using namespace std;
+
+static const int SPI_BUSES = 4;
+//each bus has a flash part behind it, streamed sequentially and wrapping at the end
+static const size_t SPI_FLASH_BYTES = 64 * 1024;
+
+struct DriverInstance {
+    int index;
+    bool open;
+    int clockHz;
+    int mode;
+    size_t flashAddress;
+    uint8_t flash[SPI_FLASH_BYTES];
+};
+
 static bool initialized = false;
 static DriverState currentState = DRIVER_STATE_UNINITIALIZED;
+static DriverInstance buses[SPI_BUSES];
+
+//moves size bytes between the buffer and flash from the current address, returns the bytes moved
+static size_t spiStream(DriverInstance* bus, void* buffer, size_t size, bool writing) {
+    uint8_t* data = static_cast<uint8_t*>(buffer);
+    size_t moved = 0;
+    while (moved < size) {
+        size_t chunk = SPI_FLASH_BYTES - bus->flashAddress;
+        if (chunk > size - moved) {
+            chunk = size - moved;
+        }
+        if (writing) {
+            memcpy(bus->flash + bus->flashAddress, data + moved, chunk);
+        } else {
+            memcpy(data + moved, bus->flash + bus->flashAddress, chunk);
+        }
+        bus->flashAddress = (bus->flashAddress + chunk) % SPI_FLASH_BYTES;
+        moved += chunk;
+    }
+    return moved;
+}
+
+//the single-buffer calls stream the same flash as the batch calls, so read() and readv()/DMA agree
+static int spiRead(DriverInstance* bus, void* buffer, size_t size) {
+    if (!initialized || !bus->open) return DRIVER_STATUS_NOT_READY;
+    if (!buffer) return DRIVER_STATUS_INVALID_PARAM;
+    cout << "[SPI" << bus->index << "] Full-duplex read " << size << " bytes" << endl;
+    return static_cast<int>(spiStream(bus, buffer, size, false));
+}
+
+static DriverStatus spiWrite(DriverInstance* bus, const void* buffer, size_t size) {
+    if (!initialized || !bus->open) return DRIVER_STATUS_NOT_READY;
+    if (!buffer) return DRIVER_STATUS_INVALID_PARAM;
+    cout << "[SPI" << bus->index << "] Full-duplex write " << size << " bytes" << endl;
+    spiStream(bus, const_cast<void*>(buffer), size, true);
+    return DRIVER_STATUS_SUCCESS;
+}
+
+static DriverStatus spiBatch(DriverInstance* bus, DriverIoDescriptor* descriptors, size_t count, bool writing) {
+    if (!bus) return DRIVER_STATUS_INVALID_PARAM;
+    if (!initialized || !bus->open) return DRIVER_STATUS_NOT_READY;
+
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!descriptors[i].buffer) {
+            descriptors[i].result = DRIVER_STATUS_INVALID_PARAM;
+            continue;
+        }
+        size_t bytes = spiStream(bus, descriptors[i].buffer, descriptors[i].size, writing);
+        descriptors[i].result = static_cast<int>(bytes);
+        totalBytes += bytes;
+    }
+    cout << "[SPI" << bus->index << "] Burst " << (writing ? "write " : "read ") << count
+         << " descriptors (" << totalBytes << " bytes)" << endl;
+    return DRIVER_STATUS_SUCCESS;
+}
+
+static DriverStatus spiConfigure(DriverInstance* bus, int parameter, int value) {
+    if (!initialized || !bus->open) return DRIVER_STATUS_NOT_READY;
+
+    switch (parameter) {
+        case 1:
+            bus->clockHz = value;
+            cout << "[SPI" << bus->index << "] Setting clock frequency: " << value << " Hz" << endl;
+            break;
+        case 2:
+            bus->mode = value;
+            cout << "[SPI" << bus->index << "] Setting SPI mode: " << value << endl;
+            break;
+        case 3:
+            bus->flashAddress = static_cast<size_t>(value) % SPI_FLASH_BYTES;
+            cout << "[SPI" << bus->index << "] Setting flash address: " << bus->flashAddress << endl;
+            break;
+        default:
+            cout << "[SPI" << bus->index << "] Unknown parameter " << parameter << endl;
+            break;
+    }
+    return DRIVER_STATUS_SUCCESS;
+}
 
 extern "C" {
     const char* driverName() {
-        return "SPI0_Driver";
+        return "SPI_Driver";
     }
 
     bool driverInit() {
         if (initialized) return true;
-        
-        cout << "[SPI] Initializing SPI hardware" << endl;
+
+        cout << "[SPI] Initializing SPI hardware (" << SPI_BUSES << " buses)" << endl;
         cout << "[SPI] Setting clock frequency: 1MHz" << endl;
         cout << "[SPI] Configuring SPI Mode 0 (CPOL=0, CPHA=0)" << endl;
         cout << "[SPI] Setting 8-bit data frame" << endl;
-        
+
+        for (int i = 0; i < SPI_BUSES; i++) {
+            buses[i].index = i;
+            buses[i].open = false;
+            buses[i].clockHz = 1000000;
+            buses[i].mode = 0;
+            buses[i].flashAddress = 0;
+            //erased flash reads back as 0xFF
+            memset(buses[i].flash, 0xFF, SPI_FLASH_BYTES);
+        }
+        //v1 callers talk to bus 0 without opening it
+        buses[0].open = true;
+
         initialized = true;
         currentState = DRIVER_STATE_INITIALIZED;
         return true;
@@ -27,13 +134,16 @@ extern "C" {
         if (initialized) {
             cout << "[SPI] Cleaning up SPI resources" << endl;
             cout << "[SPI] Disabling SPI interface" << endl;
+            for (int i = 0; i < SPI_BUSES; i++) {
+                buses[i].open = false;
+            }
             initialized = false;
             currentState = DRIVER_STATE_UNINITIALIZED;
         }
     }
 
     const char* driverVersion() {
-        return "1.0.0";
+        return "2.0.0";
     }
 
     int driverGetCapabilities() {
@@ -48,32 +158,59 @@ extern "C" {
         return initialized ? DRIVER_STATUS_SUCCESS : DRIVER_STATUS_NOT_READY;
     }
 
-    DriverStatus driverRead(void* buffer, size_t size) {
-        if (!initialized) return DRIVER_STATUS_NOT_READY;
-        cout << "[SPI] Full-duplex read " << size << " bytes" << endl;
-        return DRIVER_STATUS_SUCCESS;
+    int driverRead(void* buffer, size_t size) {
+        return spiRead(&buses[0], buffer, size);
     }
 
     DriverStatus driverWrite(const void* buffer, size_t size) {
-        if (!initialized) return DRIVER_STATUS_NOT_READY;
-        cout << "[SPI] Full-duplex write " << size << " bytes" << endl;
-        return DRIVER_STATUS_SUCCESS;
+        return spiWrite(&buses[0], buffer, size);
     }
 
     DriverStatus driverConfigure(int parameter, int value) {
-        if (!initialized) return DRIVER_STATUS_NOT_READY;
-        
-        switch (parameter) {
-            case 1:
-                cout << "[SPI] Setting clock frequency: " << value << " Hz" << endl;
-                break;
-            case 2:
-                cout << "[SPI] Setting SPI mode: " << value << endl;
-                break;
-            default:
-                cout << "[SPI] Unknown parameter " << parameter << endl;
-                break;
-        }
-        return DRIVER_STATUS_SUCCESS;
+        return spiConfigure(&buses[0], parameter, value);
+    }
+
+    int driverAbiVersion() {
+        return DRIVER_ABI_VERSION_2;
+    }
+
+    int driverInstanceCount() {
+        return SPI_BUSES;
+    }
+
+    DriverInstance* driverOpenInstance(int index) {
+        if (!initialized || index < 0 || index >= SPI_BUSES) return nullptr;
+        cout << "[SPI" << index << "] Bus opened" << endl;
+        buses[index].open = true;
+        return &buses[index];
+    }
+
+    void driverCloseInstance(DriverInstance* bus) {
+        if (!bus) return;
+        cout << "[SPI" << bus->index << "] Bus closed" << endl;
+        bus->open = false;
+    }
+
+    int driverInstanceRead(DriverInstance* bus, void* buffer, size_t size) {
+        if (!bus) return DRIVER_STATUS_INVALID_PARAM;
+        return spiRead(bus, buffer, size);
+    }
+
+    DriverStatus driverInstanceWrite(DriverInstance* bus, const void* buffer, size_t size) {
+        if (!bus) return DRIVER_STATUS_INVALID_PARAM;
+        return spiWrite(bus, buffer, size);
+    }
+
+    DriverStatus driverInstanceConfigure(DriverInstance* bus, int parameter, int value) {
+        if (!bus) return DRIVER_STATUS_INVALID_PARAM;
+        return spiConfigure(bus, parameter, value);
+    }
+
+    DriverStatus driverInstanceReadBatch(DriverInstance* bus, DriverIoDescriptor* descriptors, size_t count) {
+        return spiBatch(bus, descriptors, count, false);
+    }
+
+    DriverStatus driverInstanceWriteBatch(DriverInstance* bus, DriverIoDescriptor* descriptors, size_t count) {
+        return spiBatch(bus, descriptors, count, true);
     }
 }
@@ -1,9 +1,14 @@
 #include "DriverInterface.h"
 #include "DriverTypes.h"
 #include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 using namespace std;
 static bool initialized = false;
 static DriverState currentState = DRIVER_STATE_UNINITIALIZED;
+//the 32-bit counter free-runs at 1MHz from driverInit
+static chrono::steady_clock::time_point counterStart;
 
 extern "C" {
     const char* driverName() {
@@ -18,6 +23,7 @@ extern "C" {
         cout << "[TIMER] Configuring 32-bit timer mode" << endl;
         cout << "[TIMER] Enabling overflow interrupt" << endl;
         
+        counterStart = chrono::steady_clock::now();
         initialized = true;
         currentState = DRIVER_STATE_INITIALIZED;
         return true;
@@ -49,10 +55,14 @@ extern "C" {
         return initialized ? DRIVER_STATUS_SUCCESS : DRIVER_STATUS_NOT_READY;
     }
 
-    DriverStatus driverRead(void* buffer, size_t size) {
+    int driverRead(void* buffer, size_t size) {
         if (!initialized) return DRIVER_STATUS_NOT_READY;
+        if (!buffer || size < sizeof(uint32_t)) return DRIVER_STATUS_INVALID_PARAM;
         cout << "[TIMER] Reading timer counter value" << endl;
-        return DRIVER_STATUS_SUCCESS;
+        uint32_t counter = static_cast<uint32_t>(chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - counterStart).count());
+        memcpy(buffer, &counter, sizeof(counter));
+        return sizeof(counter);
     }
 
     DriverStatus driverWrite(const void* buffer, size_t size) {
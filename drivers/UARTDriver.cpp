@@ -2,21 +2,62 @@
 #include "DriverTypes.h"
 #include <iostream>
 using namespace std;
+
+static const int UART_INSTANCES = 4;
+
+struct DriverInstance {
+    int index;
+    bool open;
+    int baudRate;
+};
+
 static bool initialized = false;
 static DriverState currentState = DRIVER_STATE_UNINITIALIZED;
+static DriverInstance instances[UART_INSTANCES];
+
+//no receive line is simulated, so the rx fifo is always empty
+static int uartRead(DriverInstance* instance, void* buffer, size_t size) {
+    if (!initialized || !instance->open) return DRIVER_STATUS_NOT_READY;
+    cout << "[UART" << instance->index << "] Reading " << size << " bytes" << endl;
+    return 0;
+}
+
+static DriverStatus uartWrite(DriverInstance* instance, const void* buffer, size_t size) {
+    if (!initialized || !instance->open) return DRIVER_STATUS_NOT_READY;
+    cout << "[UART" << instance->index << "] Writing " << size << " bytes" << endl;
+    return DRIVER_STATUS_SUCCESS;
+}
+
+static DriverStatus uartConfigure(DriverInstance* instance, int parameter, int value) {
+    if (!initialized || !instance->open) return DRIVER_STATUS_NOT_READY;
+    if (parameter == 1) {
+        instance->baudRate = value;
+    }
+    cout << "[UART" << instance->index << "] Configuring parameter " << parameter
+              << " to value " << value << endl;
+    return DRIVER_STATUS_SUCCESS;
+}
 
 extern "C" {
     const char* driverName() {
-        return "UART0_Driver";
+        return "UART_Driver";
     }
 
     bool driverInit() {
         if (initialized) return true;
-        
-        cout << "[UART] Initializing UART hardware" << endl;
+
+        cout << "[UART] Initializing UART hardware (" << UART_INSTANCES << " ports)" << endl;
         cout << "[UART] Setting baud rate: 115200" << endl;
         cout << "[UART] Configuring 8N1 format" << endl;
-        
+
+        for (int i = 0; i < UART_INSTANCES; i++) {
+            instances[i].index = i;
+            instances[i].open = false;
+            instances[i].baudRate = 115200;
+        }
+        //v1 callers talk to port 0 without opening it
+        instances[0].open = true;
+
         initialized = true;
         currentState = DRIVER_STATE_INITIALIZED;
         return true;
@@ -25,13 +66,16 @@ extern "C" {
     void driverCleanup() {
         if (initialized) {
             cout << "[UART] Cleaning up UART resources" << endl;
+            for (int i = 0; i < UART_INSTANCES; i++) {
+                instances[i].open = false;
+            }
             initialized = false;
             currentState = DRIVER_STATE_UNINITIALIZED;
         }
     }
 
     const char* driverVersion() {
-        return "1.0.0";
+        return "2.0.0";
     }
 
     int driverGetCapabilities() {
@@ -46,22 +90,51 @@ extern "C" {
         return initialized ? DRIVER_STATUS_SUCCESS : DRIVER_STATUS_NOT_READY;
     }
 
-    DriverStatus driverRead(void* buffer, size_t size) {
-        if (!initialized) return DRIVER_STATUS_NOT_READY;
-        cout << "[UART] Reading " << size << " bytes" << endl;
-        return DRIVER_STATUS_SUCCESS;
+    int driverRead(void* buffer, size_t size) {
+        return uartRead(&instances[0], buffer, size);
     }
 
     DriverStatus driverWrite(const void* buffer, size_t size) {
-        if (!initialized) return DRIVER_STATUS_NOT_READY;
-        cout << "[UART] Writing " << size << " bytes" << endl;
-        return DRIVER_STATUS_SUCCESS;
+        return uartWrite(&instances[0], buffer, size);
     }
 
     DriverStatus driverConfigure(int parameter, int value) {
-        if (!initialized) return DRIVER_STATUS_NOT_READY;
-        cout << "[UART] Configuring parameter " << parameter 
-                  << " to value " << value << endl;
-        return DRIVER_STATUS_SUCCESS;
+        return uartConfigure(&instances[0], parameter, value);
+    }
+
+    int driverAbiVersion() {
+        return DRIVER_ABI_VERSION_2;
+    }
+
+    int driverInstanceCount() {
+        return UART_INSTANCES;
+    }
+
+    DriverInstance* driverOpenInstance(int index) {
+        if (!initialized || index < 0 || index >= UART_INSTANCES) return nullptr;
+        cout << "[UART" << index << "] Port opened" << endl;
+        instances[index].open = true;
+        return &instances[index];
+    }
+
+    void driverCloseInstance(DriverInstance* instance) {
+        if (!instance) return;
+        cout << "[UART" << instance->index << "] Port closed" << endl;
+        instance->open = false;
+    }
+
+    int driverInstanceRead(DriverInstance* instance, void* buffer, size_t size) {
+        if (!instance) return DRIVER_STATUS_INVALID_PARAM;
+        return uartRead(instance, buffer, size);
+    }
+
+    DriverStatus driverInstanceWrite(DriverInstance* instance, const void* buffer, size_t size) {
+        if (!instance) return DRIVER_STATUS_INVALID_PARAM;
+        return uartWrite(instance, buffer, size);
+    }
+
+    DriverStatus driverInstanceConfigure(DriverInstance* instance, int parameter, int value) {
+        if (!instance) return DRIVER_STATUS_INVALID_PARAM;
+        return uartConfigure(instance, parameter, value);
     }
 }
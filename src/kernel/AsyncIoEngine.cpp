@@ -0,0 +1,198 @@
+#include "AsyncIoEngine.h"
+
+using namespace std;
+
+AsyncIoEngine::AsyncIoEngine(VirtualFileSystem& fileSystem)
+    : vfs(fileSystem), outstanding(0), overflowed(false), running(true), submittedCount(0), completedCount(0),
+      submissionFullCount(0), completionBusyCount(0), completionFullCount(0) {}
+
+AsyncIoEngine::~AsyncIoEngine(){
+    stop();
+}
+
+bool AsyncIoEngine::prepare(const AsyncIoRequest& request){
+    if (!running.load(memory_order_acquire) || !submissionRing.push(request)) {
+        submissionFullCount.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+//caller holds workersMutex
+AsyncIoEngine::DeviceWorker& AsyncIoEngine::workerFor(const string& devicePath){
+    auto& slot = workers[devicePath];
+    if (!slot) {
+        slot = make_unique<DeviceWorker>();
+        DeviceWorker* worker = slot.get();
+        worker->worker = thread(&AsyncIoEngine::workerLoop, this, ref(*worker));
+    }
+    return *slot;
+}
+
+size_t AsyncIoEngine::submit(){
+    //held across the drain so stop() can't tear the workers down mid-dispatch
+    lock_guard<mutex> lock(workersMutex);
+    size_t dispatched = 0;
+    AsyncIoRequest request;
+    while (running.load(memory_order_acquire)) {
+        //every dispatched entry owns a completion slot until it is reaped
+        if (outstanding.load(memory_order_acquire) >= COMPLETION_ENTRIES) {
+            completionBusyCount.fetch_add(1, memory_order_relaxed);
+            break;
+        }
+        if (!submissionRing.pop(request)) {
+            break;
+        }
+        outstanding.fetch_add(1, memory_order_acq_rel);
+        submittedCount.fetch_add(1, memory_order_relaxed);
+        string devicePath = vfs.getDevicePath(request.io.fd);
+        if (devicePath.empty()) {
+            complete(request.userData, VirtualFileSystem::VFS_ERROR_BAD_FD);
+            continue;
+        }
+        DeviceWorker& worker = workerFor(devicePath);
+        {
+            lock_guard<mutex> queueLock(worker.queueMutex);
+            worker.pending.push_back(request);
+        }
+        worker.queueCondition.notify_one();
+        dispatched++;
+    }
+    return dispatched;
+}
+
+void AsyncIoEngine::workerLoop(DeviceWorker& worker){
+    vector<AsyncIoRequest> batch;
+    vector<VfsIoRequest> ioRequests;
+    for (;;) {
+        {
+            unique_lock<mutex> lock(worker.queueMutex);
+            worker.queueCondition.wait(lock, [&]{ return !worker.pending.empty() || !running.load(memory_order_acquire); });
+            if (!running.load(memory_order_acquire)) {
+                return;
+            }
+            batch.assign(worker.pending.begin(), worker.pending.end());
+            worker.pending.clear();
+        }
+
+        //everything queued for the device since the last wakeup goes down as one batch
+        ioRequests.clear();
+        for (const auto& request : batch) {
+            ioRequests.push_back(request.io);
+        }
+        vfs.submitBatch(ioRequests.data(), ioRequests.size());
+        for (size_t index = 0; index < batch.size(); index++) {
+            complete(batch[index].userData, ioRequests[index].result);
+        }
+    }
+}
+
+void AsyncIoEngine::complete(uint64_t userData, int result){
+    AsyncIoCompletion completion;
+    completion.userData = userData;
+    completion.result = result;
+    //once anything has overflowed, later completions queue behind it to keep their order
+    if (overflowed.load(memory_order_acquire) || !completionRing.push(completion)) {
+        lock_guard<mutex> lock(overflowMutex);
+        overflow.push_back(completion);
+        overflowed.store(true, memory_order_release);
+        completionFullCount.fetch_add(1, memory_order_relaxed);
+    }
+    completedCount.fetch_add(1, memory_order_relaxed);
+    completionEvent.signal();
+}
+
+void AsyncIoEngine::flushOverflow(){
+    lock_guard<mutex> lock(overflowMutex);
+    while (!overflow.empty() && completionRing.push(overflow.front())) {
+        overflow.pop_front();
+    }
+    if (overflow.empty()) {
+        overflowed.store(false, memory_order_release);
+    }
+}
+
+bool AsyncIoEngine::popCompletion(AsyncIoCompletion& completion){
+    bool popped = completionRing.pop(completion);
+    if (overflowed.load(memory_order_acquire)) {
+        flushOverflow();
+        if (!popped) {
+            popped = completionRing.pop(completion);
+        }
+    }
+    if (popped) {
+        //completions failed by stop() were never counted in
+        size_t current = outstanding.load(memory_order_relaxed);
+        while (current > 0 && !outstanding.compare_exchange_weak(current, current - 1, memory_order_acq_rel)) {}
+    }
+    return popped;
+}
+
+bool AsyncIoEngine::peekCompletion(AsyncIoCompletion& completion){
+    return popCompletion(completion);
+}
+
+size_t AsyncIoEngine::reapCompletions(AsyncIoCompletion* completions, size_t maxCount){
+    size_t reaped = 0;
+    while (reaped < maxCount && popCompletion(completions[reaped])) {
+        reaped++;
+    }
+    return reaped;
+}
+
+bool AsyncIoEngine::waitCompletion(AsyncIoCompletion& completion, chrono::microseconds timeout){
+    auto deadline = chrono::steady_clock::now() + timeout;
+    for (;;) {
+        if (popCompletion(completion)) {
+            return true;
+        }
+        auto now = chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        completionEvent.read(chrono::duration_cast<chrono::microseconds>(deadline - now));
+    }
+}
+
+void AsyncIoEngine::stop(){
+    if (!running.exchange(false)) {
+        return;
+    }
+    lock_guard<mutex> lock(workersMutex);
+    for (auto& pair : workers) {
+        {
+            lock_guard<mutex> queueLock(pair.second->queueMutex);
+        }
+        pair.second->queueCondition.notify_all();
+    }
+    for (auto& pair : workers) {
+        if (pair.second->worker.joinable()) {
+            pair.second->worker.join();
+        }
+    }
+
+    //anything that never reached a device fails, so callers waiting on a tag always hear back
+    for (auto& pair : workers) {
+        for (const auto& request : pair.second->pending) {
+            complete(request.userData, VirtualFileSystem::VFS_ERROR_NOT_OPEN);
+        }
+        pair.second->pending.clear();
+    }
+    AsyncIoRequest request;
+    while (submissionRing.pop(request)) {
+        complete(request.userData, VirtualFileSystem::VFS_ERROR_NOT_OPEN);
+    }
+    workers.clear();
+}
+
+AsyncIoStats AsyncIoEngine::getStatistics() const {
+    AsyncIoStats stats;
+    stats.submitted = submittedCount.load(memory_order_relaxed);
+    stats.completed = completedCount.load(memory_order_relaxed);
+    stats.submissionRingFull = submissionFullCount.load(memory_order_relaxed);
+    stats.completionBusy = completionBusyCount.load(memory_order_relaxed);
+    stats.completionRingFull = completionFullCount.load(memory_order_relaxed);
+    lock_guard<mutex> lock(workersMutex);
+    stats.deviceWorkers = workers.size();
+    return stats;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "IoEventCounter.h"
+#include "MpmcRing.h"
+#include "VirtualFileSystem.h"
+
+using namespace std;
+
+//submission queue entry, buffers and iovecs must stay valid until the completion is reaped
+struct AsyncIoRequest {
+    VfsIoRequest io;
+    uint64_t userData = 0;
+};
+
+//completion queue entry, result is bytes moved or a VFS_ERROR_* code
+struct AsyncIoCompletion {
+    uint64_t userData = 0;
+    int result = 0;
+};
+
+struct AsyncIoStats {
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t submissionRingFull;
+    //submit() calls that stopped early because every completion slot was spoken for
+    uint64_t completionBusy;
+    //completions parked on the overflow list because the ring was full
+    uint64_t completionRingFull;
+    size_t deviceWorkers;
+};
+
+//io_uring-shaped front end for the VFS descriptor calls
+//prepare() fills the submission ring, submit() hands the entries to one worker thread per device,
+//workers run everything queued for their device as one VFS batch and post to the completion ring
+//submit() only dispatches while the completion ring has room for the result (io_uring's -EBUSY), so a
+//caller that stops reaping gets back-pressure instead of a stall; completions that still find the ring
+//full (e.g. entries failed by stop()) go to an overflow list that the reap calls drain, never dropped
+class AsyncIoEngine{
+    public:
+        static constexpr size_t SUBMISSION_ENTRIES = 256;
+        static constexpr size_t COMPLETION_ENTRIES = 2 * SUBMISSION_ENTRIES;
+
+    private:
+        struct DeviceWorker{
+            mutex queueMutex;
+            condition_variable queueCondition;
+            deque<AsyncIoRequest> pending;
+            thread worker;
+        };
+
+        VirtualFileSystem& vfs;
+        MpmcRing<AsyncIoRequest, SUBMISSION_ENTRIES> submissionRing;
+        MpmcRing<AsyncIoCompletion, COMPLETION_ENTRIES> completionRing;
+        IoEventCounter completionEvent;
+        //dispatched entries whose completion hasn't been reaped yet, capped at COMPLETION_ENTRIES
+        atomic<size_t> outstanding;
+        mutex overflowMutex;
+        deque<AsyncIoCompletion> overflow;
+        atomic<bool> overflowed;
+
+        mutable mutex workersMutex;
+        unordered_map<string, unique_ptr<DeviceWorker>> workers;
+        atomic<bool> running;
+
+        atomic<uint64_t> submittedCount;
+        atomic<uint64_t> completedCount;
+        atomic<uint64_t> submissionFullCount;
+        atomic<uint64_t> completionBusyCount;
+        atomic<uint64_t> completionFullCount;
+
+        DeviceWorker& workerFor(const string& devicePath);
+        void workerLoop(DeviceWorker& worker);
+        void complete(uint64_t userData, int result);
+        //moves overflowed completions into the ring while it has room
+        void flushOverflow();
+        bool popCompletion(AsyncIoCompletion& completion);
+
+    public:
+        explicit AsyncIoEngine(VirtualFileSystem& fileSystem);
+        ~AsyncIoEngine();
+
+        AsyncIoEngine(const AsyncIoEngine&) = delete;
+        AsyncIoEngine& operator = (const AsyncIoEngine&) = delete;
+
+        //queues one entry without starting it, false when the submission ring is full
+        bool prepare(const AsyncIoRequest& request);
+        //dispatches prepared entries to their device workers until the completion ring has no room left
+        //for their results, the rest stay prepared for the next submit(); returns how many were dispatched
+        size_t submit();
+
+        //polling side of the completion ring
+        bool peekCompletion(AsyncIoCompletion& completion);
+        size_t reapCompletions(AsyncIoCompletion* completions, size_t maxCount);
+        //blocks until a completion is available or the timeout passes
+        bool waitCompletion(AsyncIoCompletion& completion, chrono::microseconds timeout);
+
+        //signalled once per posted completion, for callers that wait on several sources
+        IoEventCounter& getCompletionEvent() {return completionEvent;}
+
+        //fails everything still queued with VFS_ERROR_NOT_OPEN and joins the workers
+        void stop();
+        AsyncIoStats getStatistics() const;
+};
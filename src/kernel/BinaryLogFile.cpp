@@ -0,0 +1,130 @@
+#include "BinaryLogFile.h"
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifdef _WIN32
+BinaryLogFile::BinaryLogFile() : mapping(nullptr), capacity(0), writeOffset(0), droppedEntries(0),
+                                 fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr){}
+#else
+BinaryLogFile::BinaryLogFile() : mapping(nullptr), capacity(0), writeOffset(0), droppedEntries(0), fileDescriptor(-1){}
+#endif
+
+BinaryLogFile::~BinaryLogFile(){
+    close();
+}
+
+bool BinaryLogFile::open(const string& filePath, size_t capacityBytes){
+    if (isOpen() || capacityBytes == 0) {
+        return false;
+    }
+    size_t fileSize = sizeof(BinaryLog::FileHeader) + capacityBytes;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                            static_cast<DWORD>(static_cast<uint64_t>(fileSize) >> 32),
+                                            static_cast<DWORD>(fileSize & 0xFFFFFFFFu), nullptr);
+    if (!fileMapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(fileMapping, FILE_MAP_WRITE, 0, 0, fileSize);
+    if (!view) {
+        CloseHandle(fileMapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = fileMapping;
+#else
+    int descriptor = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        return false;
+    }
+    if (ftruncate(descriptor, static_cast<off_t>(fileSize)) != 0) {
+        ::close(descriptor);
+        return false;
+    }
+    void* view = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (view == MAP_FAILED) {
+        ::close(descriptor);
+        return false;
+    }
+    fileDescriptor = descriptor;
+#endif
+
+    mapping = static_cast<unsigned char*>(view);
+    capacity = capacityBytes;
+    path = filePath;
+    writeOffset = 0;
+    droppedEntries = 0;
+
+    BinaryLog::FileHeader fileHeader;
+    memcpy(fileHeader.magic, BinaryLog::MAGIC, sizeof(fileHeader.magic));
+    fileHeader.version = BinaryLog::VERSION;
+    fileHeader.headerSize = sizeof(BinaryLog::FileHeader);
+    fileHeader.capacity = capacityBytes;
+    fileHeader.usedBytes = 0;
+    memcpy(mapping, &fileHeader, sizeof(fileHeader));
+    return true;
+}
+
+void BinaryLogFile::close(){
+    if (!isOpen()) {
+        return;
+    }
+    size_t used = getUsedBytes();
+    header()->usedBytes = used;
+    size_t mappedSize = sizeof(BinaryLog::FileHeader) + capacity;
+    size_t finalSize = sizeof(BinaryLog::FileHeader) + used;
+
+#ifdef _WIN32
+    FlushViewOfFile(mapping, mappedSize);
+    UnmapViewOfFile(mapping);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(finalSize);
+    SetFilePointerEx(static_cast<HANDLE>(fileHandle), size, nullptr, FILE_BEGIN);
+    SetEndOfFile(static_cast<HANDLE>(fileHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#else
+    msync(mapping, mappedSize, MS_SYNC);
+    munmap(mapping, mappedSize);
+    if (ftruncate(fileDescriptor, static_cast<off_t>(finalSize)) != 0) {
+        //the header still records usedBytes, the decoder stops there
+    }
+    ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+    mapping = nullptr;
+    capacity = 0;
+}
+
+bool BinaryLogFile::append(const void* entry, size_t size){
+    size_t offset = writeOffset.fetch_add(size, memory_order_relaxed);
+    if (offset + size > capacity) {
+        droppedEntries.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    memcpy(data() + offset, entry, size);
+    return true;
+}
+
+size_t BinaryLogFile::getUsedBytes() const {
+    size_t used = writeOffset.load(memory_order_relaxed);
+    return used < capacity ? used : capacity;
+}
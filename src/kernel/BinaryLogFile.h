@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "BinaryLogFormat.h"
+
+using namespace std;
+
+//fixed-size memory-mapped log file, any number of threads may append concurrently:
+//space is reserved with one fetch_add and filled with memcpy, nothing is formatted
+class BinaryLogFile{
+    private:
+        string path;
+        unsigned char* mapping;
+        size_t capacity;
+        atomic<size_t> writeOffset;
+        atomic<uint64_t> droppedEntries;
+
+#ifdef _WIN32
+        void* fileHandle;
+        void* mappingHandle;
+#else
+        int fileDescriptor;
+#endif
+
+        BinaryLog::FileHeader* header() const {return reinterpret_cast<BinaryLog::FileHeader*>(mapping);}
+        unsigned char* data() const {return mapping + sizeof(BinaryLog::FileHeader);}
+
+    public:
+        BinaryLogFile();
+        ~BinaryLogFile();
+
+        BinaryLogFile(const BinaryLogFile&) = delete;
+        BinaryLogFile& operator = (const BinaryLogFile&) = delete;
+
+        //capacity is the space for entries, the file is that plus the header
+        bool open(const string& filePath, size_t capacityBytes);
+        //records the used size and shrinks the file to it
+        void close();
+        bool isOpen() const {return mapping != nullptr;}
+
+        //false once the file is full, the entry is counted as dropped
+        bool append(const void* entry, size_t size);
+
+        size_t getUsedBytes() const;
+        uint64_t getDroppedEntries() const {return droppedEntries;}
+        const string& getPath() const {return path;}
+};
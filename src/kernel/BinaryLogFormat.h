@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+//on-disk layout of the binary log, shared by Logger and tools/vos_logdecode
+//
+//  BinaryLogHeader
+//  entries, each a BinaryLogEntryHeader followed by its payload:
+//    FORMAT_DEFINITION - the format string ("{}" marks an argument)
+//    EVENT             - argCount arguments, each a type byte followed by
+//                        8 bytes (I64/U64/F64) or a length byte + bytes (STR)
+//
+//all integers are in host byte order, the decoder runs on the same machine
+
+namespace BinaryLog{
+    static constexpr char MAGIC[8] = {'V', 'O', 'S', 'B', 'L', 'O', 'G', '1'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t MAX_ENTRY_SIZE = 512;
+    static constexpr size_t MAX_STRING_ARGUMENT = 255;
+
+    enum class EntryKind : uint8_t{
+        FORMAT_DEFINITION = 1,
+        EVENT = 2
+    };
+
+    enum class ArgumentType : uint8_t{
+        I64 = 1,
+        U64 = 2,
+        F64 = 3,
+        STR = 4
+    };
+
+    struct FileHeader{
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint64_t capacity;
+        //bytes of entries written, 0 if the log was not closed cleanly
+        uint64_t usedBytes;
+    };
+
+    struct EntryHeader{
+        //whole entry including this header, 0 marks the end of the data
+        uint16_t size;
+        EntryKind kind;
+        uint8_t messageType;
+        uint16_t formatId;
+        uint16_t argCount;
+        uint64_t tick;
+    };
+
+    //replaces each "{}" in format with the next argument, extra "{}" stay as they are
+    inline string substituteArguments(const char* format, size_t length, const string* arguments, size_t argumentCount){
+        string result;
+        result.reserve(length + argumentCount * 8);
+        size_t next = 0;
+        for (size_t index = 0; index < length; index++) {
+            if (format[index] == '{' && index + 1 < length && format[index + 1] == '}' && next < argumentCount) {
+                result += arguments[next++];
+                index++;
+            }
+            else{
+                result += format[index];
+            }
+        }
+        return result;
+    }
+
+    inline string substituteArguments(const string& format, const string* arguments, size_t argumentCount){
+        return substituteArguments(format.data(), format.size(), arguments, argumentCount);
+    }
+}
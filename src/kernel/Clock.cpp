@@ -7,7 +7,13 @@
 
 using namespace std;
 
-Clock::Clock() : running(false), initialized(false){}
+static uint64_t elapsedMicroseconds(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to){
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(to - from).count());
+}
+
+Clock::Clock() : running(false), initialized(false), missedTickPolicy(MissedTickPolicy::CATCH_UP){
+    resetStatistics();
+}
 
 Clock::~Clock(){
     stop();
@@ -32,29 +38,130 @@ void Clock::stop(){
     initialized = false;
 }
 void Clock::tick() {
+    runTick(1);
+}
+
+//elapsedTicks > 1 only for COALESCE, the kernel tick counter and the timers jump together
+void Clock::runTick(int elapsedTicks) {
     if (!running) return;
-    Kernel::incrementTicks();
+    Kernel::incrementTicks(static_cast<uint64_t>(elapsedTicks));
     
     Scheduler& scheduler = Kernel::getInstance().getScheduler();
-    scheduler.updateTaskTimers();       
+    auto tickStart = chrono::steady_clock::now();
+    scheduler.processPendingCommands();
+    auto commandsDone = chrono::steady_clock::now();
+    scheduler.updateTaskTimers(elapsedTicks);       
+    auto timersDone = chrono::steady_clock::now();
     scheduler.executeNextReadyTask();  
+    auto executeDone = chrono::steady_clock::now();
 
     if (running) {
-        Kernel::getInstance().getLogger().log(
-            MessageType::HEARTBEAT, 
-            "System heartbeat - Tick " + to_string(Kernel::getTicks())
-        );
+        VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::HEARTBEAT, "System heartbeat - Tick {}", Kernel::getTicks());
+    }
+    auto tickEnd = chrono::steady_clock::now();
+
+    uint64_t tickMicroseconds = elapsedMicroseconds(tickStart, tickEnd);
+    lastCommandMicroseconds.store(elapsedMicroseconds(tickStart, commandsDone), memory_order_relaxed);
+    lastTimerMicroseconds.store(elapsedMicroseconds(commandsDone, timersDone), memory_order_relaxed);
+    lastExecuteMicroseconds.store(elapsedMicroseconds(timersDone, executeDone), memory_order_relaxed);
+    lastHeartbeatMicroseconds.store(elapsedMicroseconds(executeDone, tickEnd), memory_order_relaxed);
+    lastTickMicroseconds.store(tickMicroseconds, memory_order_relaxed);
+    if (tickMicroseconds > worstTickMicroseconds.load(memory_order_relaxed)) {
+        worstTickMicroseconds.store(tickMicroseconds, memory_order_relaxed);
+    }
+    tickCount.fetch_add(1, memory_order_relaxed);
+
+    if (tickEnd - tickStart > TICK_INTERVALS) {
+        overrunCount.fetch_add(1, memory_order_relaxed);
+        Kernel::getInstance().getLogger().log(MessageType::ERRORS, 
+            "Tick overrun: " + to_string(tickMicroseconds) + "us (budget " +
+            to_string(chrono::duration_cast<chrono::microseconds>(TICK_INTERVALS).count()) + "us)");
     }
 }
 
 void Clock::clockLoop(){
     auto nextTick = chrono::steady_clock::now() + TICK_INTERVALS;
+    //missed deadlines already counted while catching up
+    int alreadyCounted = 0;
 
     while (running) {
         this_thread::sleep_until(nextTick);
-        if (running) {
-            tick();
-            nextTick+=TICK_INTERVALS;
+        if (!running) {
+            break;
+        }
+
+        //deadlines after nextTick that have also passed by now
+        auto now = chrono::steady_clock::now();
+        int missed = static_cast<int>((now - nextTick) / TICK_INTERVALS);
+        if (missed > alreadyCounted) {
+            missedTickCount.fetch_add(static_cast<uint64_t>(missed - alreadyCounted), memory_order_relaxed);
+        }
+        alreadyCounted = 0;
+
+        switch (missedTickPolicy.load()) {
+            case MissedTickPolicy::CATCH_UP:
+                //the missed deadlines stay in the past, the next sleeps return immediately
+                runTick(1);
+                nextTick += TICK_INTERVALS;
+                alreadyCounted = missed > 0 ? missed - 1 : 0;
+                break;
+            case MissedTickPolicy::SKIP:
+                runTick(1);
+                skippedTickCount.fetch_add(static_cast<uint64_t>(missed), memory_order_relaxed);
+                nextTick += TICK_INTERVALS * (missed + 1);
+                break;
+            case MissedTickPolicy::COALESCE:
+                runTick(missed + 1);
+                coalescedTickCount.fetch_add(static_cast<uint64_t>(missed), memory_order_relaxed);
+                nextTick += TICK_INTERVALS * (missed + 1);
+                break;
         }
     }
-}
\ No newline at end of file
+}
+
+ClockStats Clock::getStatistics() const {
+    ClockStats stats;
+    stats.ticks = tickCount.load(memory_order_relaxed);
+    stats.overruns = overrunCount.load(memory_order_relaxed);
+    stats.missedTicks = missedTickCount.load(memory_order_relaxed);
+    stats.skippedTicks = skippedTickCount.load(memory_order_relaxed);
+    stats.coalescedTicks = coalescedTickCount.load(memory_order_relaxed);
+    stats.commandMicroseconds = lastCommandMicroseconds.load(memory_order_relaxed);
+    stats.timerMicroseconds = lastTimerMicroseconds.load(memory_order_relaxed);
+    stats.executeMicroseconds = lastExecuteMicroseconds.load(memory_order_relaxed);
+    stats.heartbeatMicroseconds = lastHeartbeatMicroseconds.load(memory_order_relaxed);
+    stats.tickMicroseconds = lastTickMicroseconds.load(memory_order_relaxed);
+    stats.worstTickMicroseconds = worstTickMicroseconds.load(memory_order_relaxed);
+    return stats;
+}
+
+void Clock::resetStatistics(){
+    tickCount = 0;
+    overrunCount = 0;
+    missedTickCount = 0;
+    skippedTickCount = 0;
+    coalescedTickCount = 0;
+    lastCommandMicroseconds = 0;
+    lastTimerMicroseconds = 0;
+    lastExecuteMicroseconds = 0;
+    lastHeartbeatMicroseconds = 0;
+    lastTickMicroseconds = 0;
+    worstTickMicroseconds = 0;
+}
+
+void Clock::displayStatistics() const {
+    ClockStats stats = getStatistics();
+    Logger& logger = Kernel::getInstance().getLogger();
+    logger.log(MessageType::HEADER, "Clock Statistics");
+    logger.log(MessageType::STATUS, "Ticks run: " + to_string(stats.ticks) +
+                                    ", overruns: " + to_string(stats.overruns) +
+                                    ", missed deadlines: " + to_string(stats.missedTicks));
+    logger.log(MessageType::STATUS, "Skipped ticks: " + to_string(stats.skippedTicks) +
+                                    ", coalesced ticks: " + to_string(stats.coalescedTicks));
+    logger.log(MessageType::STATUS, "Last tick: " + to_string(stats.tickMicroseconds) + "us (commands " +
+                                    to_string(stats.commandMicroseconds) + "us, timers " +
+                                    to_string(stats.timerMicroseconds) + "us, execute " +
+                                    to_string(stats.executeMicroseconds) + "us, heartbeat " +
+                                    to_string(stats.heartbeatMicroseconds) + "us)");
+    logger.log(MessageType::STATUS, "Worst tick: " + to_string(stats.worstTickMicroseconds) + "us");
+}
@@ -1,17 +1,62 @@
 #pragma once
 #include<atomic>
+#include <cstdint>
 #include <thread>
 #include<chrono>
 
 using namespace std;
 class Scheduler;
+
+//what clockLoop does when it wakes up after one or more tick deadlines have passed
+//CATCH_UP - run every missed tick back to back (bursty, keeps tick count == wall time)
+//SKIP     - drop the missed ticks and realign to the next deadline
+//COALESCE - run one tick that advances the timers by all the missed ticks
+enum class MissedTickPolicy{
+    CATCH_UP,
+    SKIP,
+    COALESCE
+};
+
+struct ClockStats{
+    uint64_t ticks;
+    //ticks whose work took longer than TICK_INTERVALS
+    uint64_t overruns;
+    //deadlines that had already passed when the loop woke up
+    uint64_t missedTicks;
+    uint64_t skippedTicks;
+    uint64_t coalescedTicks;
+
+    //last tick, microseconds
+    uint64_t commandMicroseconds;
+    uint64_t timerMicroseconds;
+    uint64_t executeMicroseconds;
+    uint64_t heartbeatMicroseconds;
+    uint64_t tickMicroseconds;
+    uint64_t worstTickMicroseconds;
+};
+
 class Clock{
     private:
         atomic<bool> running;
         atomic<bool> initialized;
         thread clockThread;
+        atomic<MissedTickPolicy> missedTickPolicy;
+
+        //written by the clock thread only, relaxed loads elsewhere
+        atomic<uint64_t> tickCount;
+        atomic<uint64_t> overrunCount;
+        atomic<uint64_t> missedTickCount;
+        atomic<uint64_t> skippedTickCount;
+        atomic<uint64_t> coalescedTickCount;
+        atomic<uint64_t> lastCommandMicroseconds;
+        atomic<uint64_t> lastTimerMicroseconds;
+        atomic<uint64_t> lastExecuteMicroseconds;
+        atomic<uint64_t> lastHeartbeatMicroseconds;
+        atomic<uint64_t> lastTickMicroseconds;
+        atomic<uint64_t> worstTickMicroseconds;
 
         void clockLoop();
+        void runTick(int elapsedTicks);
 
     public:
         Clock();
@@ -25,5 +70,12 @@ class Clock{
 
         void tick();
 
+        void setMissedTickPolicy(MissedTickPolicy policy) {missedTickPolicy = policy;}
+        MissedTickPolicy getMissedTickPolicy() const {return missedTickPolicy;}
+
+        ClockStats getStatistics() const;
+        void resetStatistics();
+        void displayStatistics() const;
+
         static constexpr chrono::milliseconds TICK_INTERVALS{100};
-};
\ No newline at end of file
+};
@@ -1,17 +1,89 @@
 #pragma once
+#include <cstddef>
 #include <string>
 #include <mutex>
 
+//one segment of a scatter/gather transfer, same shape as POSIX struct iovec
+struct IoVec {
+    void* base;
+    size_t length;
+};
+
 class Device {
     public:
         virtual ~Device() = default;
-        virtual std::string read() = 0;
-        virtual bool write(const std::string& data) = 0;
+
+        //the caller's buffer goes straight to the driver, no staging copy and no size cap
+        //return bytes moved or a negative driver status
+        virtual int read(void* buffer, size_t size) = 0;
+        virtual int write(const void* buffer, size_t size) = 0;
+
+        //vectored I/O over iovcnt segments, returns total bytes or the error from the first segment
+        //default runs the segments back to back and stops early on a short or failed transfer
+        virtual int readv(const IoVec* iov, int iovcnt) {
+            int total = 0;
+            for (int i = 0; i < iovcnt; i++) {
+                int result = read(iov[i].base, iov[i].length);
+                if (result < 0) {
+                    return total > 0 ? total : result;
+                }
+                total += result;
+                if (static_cast<size_t>(result) < iov[i].length) {
+                    break;
+                }
+            }
+            return total;
+        }
+        virtual int writev(const IoVec* iov, int iovcnt) {
+            int total = 0;
+            for (int i = 0; i < iovcnt; i++) {
+                int result = write(iov[i].base, iov[i].length);
+                if (result < 0) {
+                    return total > 0 ? total : result;
+                }
+                total += result;
+                if (static_cast<size_t>(result) < iov[i].length) {
+                    break;
+                }
+            }
+            return total;
+        }
+
+        //independent transfers in one call, one result per segment (bytes or a negative status)
+        //default issues them one by one, drivers with batch entry points take them in a single crossing
+        virtual void readBatch(const IoVec* iov, int* results, int count) {
+            for (int i = 0; i < count; i++) {
+                results[i] = read(iov[i].base, iov[i].length);
+            }
+        }
+        virtual void writeBatch(const IoVec* iov, int* results, int count) {
+            for (int i = 0; i < count; i++) {
+                results[i] = write(iov[i].base, iov[i].length);
+            }
+        }
+
+        //string convenience wrappers, these copy and read at most DEFAULT_READ_SIZE bytes
+        static constexpr size_t DEFAULT_READ_SIZE = 1024;
+        std::string read() {
+            std::string data(DEFAULT_READ_SIZE, '\0');
+            int result = read(&data[0], data.size());
+            data.resize(result > 0 ? static_cast<size_t>(result) : 0);
+            return data;
+        }
+        bool write(const std::string& data) {
+            return write(data.data(), data.size()) >= 0;
+        }
+
         virtual std::string getName() const = 0;
         virtual bool isReady() const = 0;
         virtual std::string getType() const = 0;
         virtual std::string getStatus() const = 0;
         virtual bool configure(int parameter, int value) = 0;
+        //true if the device reports readiness through VirtualFileSystem::signalDeviceEvent,
+        //otherwise poll treats it as always readable and writable
+        virtual bool signalsReadiness() const {return false;}
+        //true if the device can be driven by the DMA controller
+        virtual bool supportsDma() const {return false;}
         virtual bool initialise() = 0;
         virtual void cleanup() = 0;
 
@@ -2,6 +2,8 @@
 #include "Kernel.h"
 #include "Logger.h"
 #include "DeviceRegistry.h"
+#include "DriverTypes.h"
+#include "InterruptController.h"
 #include <cstring>
 #include <chrono>
 #include <exception>
@@ -132,6 +134,7 @@ bool DllLoader::initializeAndRegisterDriver(LoadedDriver& driver){
 
     logger.log(MessageType::INIT, "Registering device with kernel: " + driverName);
     registerDriverWithKernel(driverName);
+    attachInterrupt(driver, driverName);
 
     logger.log(MessageType::INIT, "Driver " + driverName + " initialization complete");
 
@@ -165,6 +168,66 @@ void DllLoader::registerDriverWithKernel(const string& name){
     deviceRegistry.registerDevice(name, "hardware device"); 
 }
 
+//gives the driver an IRQ line whose default action flags VFS_POLLPRI on every device it backs,
+//so pollers and blocked waiters wake on the event instead of on the next tick
+void DllLoader::attachInterrupt(LoadedDriver& driver, const string& driverName){
+    if (!driver.functions.driverAttachInterrupt) {
+        return;
+    }
+    Kernel& kernel = Kernel::getInstance();
+    InterruptController& interrupts = kernel.getInterrupts();
+    int irq = interrupts.allocateIrq(driverName);
+    if (irq < 0) {
+        logger.log(MessageType::DLL_LOADER, "No free IRQ line for: " + driverName);
+        return;
+    }
+
+    VirtualFileSystem& vfs = kernel.getVfs();
+    vector<string> devicePaths;
+    for (int index = 0; index < driver.instanceCount; index++) {
+        devicePaths.push_back(vfs.generateDevicePath(driverName, index));
+    }
+    //the path lookup takes the VFS namespace lock, which the ISR thread must never wait on,
+    //so the top half only claims the event and the signalling runs as the bottom half
+    interrupts.requestIrq(irq, [](const IrqEvent&){
+        return IrqResult::WAKE_BOTTOM_HALF;
+    }, [&vfs, devicePaths](const IrqEvent&){
+        for (const auto& devicePath : devicePaths) {
+            vfs.signalDeviceEvent(devicePath, VirtualFileSystem::VFS_POLLPRI);
+        }
+    });
+    //a quiet line delivers each edge at once; a storm is capped at one delivery per DRIVER_IRQ_MAX_DELAY
+    //and, once it keeps filling whole batches, the line is masked and polled
+    IrqModeration moderation;
+    moderation.maxEvents = DRIVER_IRQ_MAX_EVENTS;
+    moderation.maxDelay = DRIVER_IRQ_MAX_DELAY;
+    moderation.pollAfterFullBatches = DRIVER_IRQ_POLL_AFTER;
+    moderation.pollInterval = DRIVER_IRQ_POLL_INTERVAL;
+    interrupts.setModeration(irq, moderation);
+
+    typedef void(*DriverAttachInterruptFunc)(DriverIrqRaise, void*);
+    DriverAttachInterruptFunc attachFunc = reinterpret_cast<DriverAttachInterruptFunc>(
+        reinterpret_cast<void*>(driver.functions.driverAttachInterrupt)
+    );
+    attachFunc(&InterruptController::driverRaise, interrupts.getDriverContext(irq));
+    driver.irq = irq;
+    logger.log(MessageType::DLL_LOADER, "IRQ " + to_string(irq) + " assigned to " + driverName);
+}
+
+//the driver must stop raising before its line can be handed to someone else
+void DllLoader::detachInterrupt(LoadedDriver& driver){
+    if (driver.irq < 0) {
+        return;
+    }
+    typedef void(*DriverAttachInterruptFunc)(DriverIrqRaise, void*);
+    DriverAttachInterruptFunc attachFunc = reinterpret_cast<DriverAttachInterruptFunc>(
+        reinterpret_cast<void*>(driver.functions.driverAttachInterrupt)
+    );
+    attachFunc(nullptr, nullptr);
+    Kernel::getInstance().getInterrupts().freeIrq(driver.irq);
+    driver.irq = -1;
+}
+
 void DllLoader::cleanupFailedDriver(unique_ptr<LoadedDriver> driver){
     if (driver) {
         if (driver->handle) {
@@ -198,9 +261,76 @@ bool DllLoader::resolveFunctions(LoadedDriver& driver) {
         }
         logger.log(MessageType::DLL_LOADER, "resolved function:" + funcName);
     }
+    resolveInstanceFunctions(driver);
+
+    driver.functions.driverReadBatch = getFunctionAddress(driver.handle, "driverReadBatch");
+    driver.functions.driverWriteBatch = getFunctionAddress(driver.handle, "driverWriteBatch");
+    driver.functions.driverAttachInterrupt = getFunctionAddress(driver.handle, "driverAttachInterrupt");
+    if (driver.functions.driverReadBatch || driver.functions.driverWriteBatch) {
+        logger.log(MessageType::DLL_LOADER, string("batch entry points:") +
+            (driver.functions.driverReadBatch ? " read" : "") + (driver.functions.driverWriteBatch ? " write" : ""));
+    }
     return true;
 }
 
+//v2 exports are optional, a driver missing any of them is loaded as v1
+void DllLoader::resolveInstanceFunctions(LoadedDriver& driver) {
+    driver.functions.driverAbiVersion = getFunctionAddress(driver.handle, "driverAbiVersion");
+    if (!driver.functions.driverAbiVersion) {
+        return;
+    }
+    typedef int(*DriverAbiVersionFunc)();
+    DriverAbiVersionFunc versionFunc = reinterpret_cast<DriverAbiVersionFunc>(
+        reinterpret_cast<void*>(driver.functions.driverAbiVersion)
+    );
+    int abiVersion = versionFunc();
+    if (abiVersion < 2) {
+        return;
+    }
+
+    vector<pair<string, FunctionPtr*>> instanceFunctions = {
+        {"driverInstanceCount", &driver.functions.driverInstanceCount},
+        {"driverOpenInstance", &driver.functions.driverOpenInstance},
+        {"driverCloseInstance", &driver.functions.driverCloseInstance},
+        {"driverInstanceRead", &driver.functions.driverInstanceRead},
+        {"driverInstanceWrite", &driver.functions.driverInstanceWrite},
+        {"driverInstanceConfigure", &driver.functions.driverInstanceConfigure},
+    };
+    for (const auto& funcPair : instanceFunctions) {
+        *funcPair.second = getFunctionAddress(driver.handle, funcPair.first);
+        if (!*funcPair.second) {
+            logger.log(MessageType::DLL_LOADER, "ABI v" + to_string(abiVersion) + " driver missing " + funcPair.first + ", falling back to v1");
+            for (const auto& clearPair : instanceFunctions) {
+                *clearPair.second = nullptr;
+            }
+            return;
+        }
+    }
+
+    typedef int(*DriverInstanceCountFunc)();
+    DriverInstanceCountFunc countFunc = reinterpret_cast<DriverInstanceCountFunc>(
+        reinterpret_cast<void*>(driver.functions.driverInstanceCount)
+    );
+    int instanceCount = countFunc();
+    if (instanceCount < 1) {
+        logger.log(MessageType::DLL_LOADER, "Driver reports no instances, falling back to v1");
+        for (const auto& clearPair : instanceFunctions) {
+            *clearPair.second = nullptr;
+        }
+        return;
+    }
+    driver.abiVersion = abiVersion;
+    driver.instanceCount = instanceCount;
+    logger.log(MessageType::DLL_LOADER, "driver ABI v" + to_string(abiVersion) + ", " + to_string(instanceCount) + " instances");
+
+    driver.functions.driverInstanceReadBatch = getFunctionAddress(driver.handle, "driverInstanceReadBatch");
+    driver.functions.driverInstanceWriteBatch = getFunctionAddress(driver.handle, "driverInstanceWriteBatch");
+    if (driver.functions.driverInstanceReadBatch || driver.functions.driverInstanceWriteBatch) {
+        logger.log(MessageType::DLL_LOADER, string("instance batch entry points:") +
+            (driver.functions.driverInstanceReadBatch ? " read" : "") + (driver.functions.driverInstanceWriteBatch ? " write" : ""));
+    }
+}
+
 bool DllLoader::validateDriver(const LoadedDriver& driver) {
     // Fixed: Cast to void* first, then to target function type
     typedef const char*(*DriverNameFunc)();
@@ -321,6 +451,7 @@ void DllLoader::displayLoadedDrivers() const {
         logger.log(MessageType::STATUS, "  Type: " + to_string(type));
         logger.log(MessageType::STATUS, "  File: " + driver->filePath);
         logger.log(MessageType::STATUS, "  Capabilities: 0x" + to_string(capabilities));
+        logger.log(MessageType::STATUS, "  ABI: v" + to_string(driver->abiVersion) + " (" + to_string(driver->instanceCount) + " instances)");
         logger.log(MessageType::STATUS, "  Initialized: " + string(driver->initialized ? "Yes" : "No"));
     }
 }
@@ -344,6 +475,7 @@ void DllLoader::unloadAllDrivers() {
         const string& name = driverPair.first;
         unique_ptr<LoadedDriver>& driver = driverPair.second;
         
+        detachInterrupt(*driver);
         if (driver->initialized) {
             typedef void(*DriverCleanupFunc)();
             DriverCleanupFunc cleanupFunc = reinterpret_cast<DriverCleanupFunc>(
@@ -29,6 +29,24 @@ struct DriverFunctions {
     FunctionPtr driverRead;
     FunctionPtr driverWrite;
     FunctionPtr driverConfigure;
+
+    //ABI v2, null for v1 drivers
+    FunctionPtr driverAbiVersion;
+    FunctionPtr driverInstanceCount;
+    FunctionPtr driverOpenInstance;
+    FunctionPtr driverCloseInstance;
+    FunctionPtr driverInstanceRead;
+    FunctionPtr driverInstanceWrite;
+    FunctionPtr driverInstanceConfigure;
+
+    //optional batch entry points, null when the driver doesn't export them
+    FunctionPtr driverReadBatch;
+    FunctionPtr driverWriteBatch;
+    //optional per-instance batch entry points, only looked up for v2 drivers
+    FunctionPtr driverInstanceReadBatch;
+    FunctionPtr driverInstanceWriteBatch;
+    //optional, drivers that raise interrupts
+    FunctionPtr driverAttachInterrupt;
 };
 
 class LoadedDriver {
@@ -38,11 +56,16 @@ public:
     DllHandle handle;
     DriverFunctions functions;
     bool initialized;
+    //1 for drivers without the v2 exports, instanceCount is always 1 for them
+    int abiVersion;
+    int instanceCount;
+    //-1 unless the driver attached to an interrupt line
+    int irq;
     chrono::steady_clock::time_point loadTime;
     chrono::steady_clock::time_point initTime;
     
     LoadedDriver(const string& n, const string& path, DllHandle h)
-        : name(n), filePath(path), handle(h), initialized(false) {
+        : name(n), filePath(path), handle(h), functions(), initialized(false), abiVersion(1), instanceCount(1), irq(-1) {
             loadTime = chrono::steady_clock::now();
         }
 };
@@ -54,16 +77,24 @@ private:
 
     static constexpr int INIT_TIMEOUT_MS = 2000;
     static constexpr int MAX_DRIVER_NAME_LENGTH = 32;
+    //interrupt moderation applied to every driver's line, InterruptController::setModeration overrides it
+    static constexpr uint32_t DRIVER_IRQ_MAX_EVENTS = 32;
+    static constexpr chrono::microseconds DRIVER_IRQ_MAX_DELAY{500};
+    static constexpr uint32_t DRIVER_IRQ_POLL_AFTER = 4;
+    static constexpr chrono::microseconds DRIVER_IRQ_POLL_INTERVAL{1000};
     
     DllHandle loadLibrary(const string& path);
     FunctionPtr getFunctionAddress(DllHandle handle, const string& functionName);
     void unloadLibrary(DllHandle handle);
     bool resolveFunctions(LoadedDriver& driver);
+    void resolveInstanceFunctions(LoadedDriver& driver);
     bool validateDriver(const LoadedDriver& driver);
 
     bool initializeAndRegisterDriver(LoadedDriver& driver);
     bool callDriverInitWithTimeout(function<bool()> initFunc, int timeoutMs);
     void registerDriverWithKernel(const string& driverName);
+    void attachInterrupt(LoadedDriver& driver, const string& driverName);
+    void detachInterrupt(LoadedDriver& driver);
     void cleanupFailedDriver(unique_ptr<LoadedDriver> driver);
 
 public:
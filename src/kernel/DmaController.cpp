@@ -0,0 +1,327 @@
+#include "DmaController.h"
+
+using namespace std;
+
+DmaController::DmaController(VirtualFileSystem& fileSystem)
+    : vfs(fileSystem), nextChannelId(0), outstanding(0), overflowed(false), doorbell(false), running(true),
+      submittedCount(0), completedCount(0), bytesCount(0), burstCount(0), descriptorFullCount(0),
+      completionBusyCount(0), completionFullCount(0) {
+    engine = thread(&DmaController::engineLoop, this);
+}
+
+DmaController::~DmaController(){
+    stop();
+}
+
+shared_ptr<DmaController::Channel> DmaController::channelFor(int channel) const {
+    lock_guard<mutex> lock(channelsMutex);
+    auto it = channels.find(channel);
+    return it != channels.end() ? it->second : nullptr;
+}
+
+int DmaController::openChannel(const string& devicePath){
+    if (!running.load(memory_order_acquire)) {
+        return VirtualFileSystem::VFS_ERROR_NOT_OPEN;
+    }
+    //the channel's own descriptor keeps the device open and gives it the normal VFS locking,
+    //capabilities are checked through it so the device can't go away between lookup and check
+    uint64_t generation = 0;
+    int fd = vfs.openDevice(devicePath, VirtualFileSystem::VFS_O_RDWR, &generation);
+    if (fd < 0) {
+        return fd;
+    }
+    if (!vfs.supportsDma(fd)) {
+        vfs.close(fd, generation);
+        return VirtualFileSystem::VFS_ERROR_ACCESS;
+    }
+
+    auto channel = make_shared<Channel>();
+    channel->fd = fd;
+    channel->generation = generation;
+    channel->devicePath = devicePath;
+    lock_guard<mutex> lock(channelsMutex);
+    channel->id = nextChannelId++;
+    channels[channel->id] = channel;
+    return channel->id;
+}
+
+int DmaController::closeChannel(int channel){
+    shared_ptr<Channel> target;
+    {
+        lock_guard<mutex> lock(channelsMutex);
+        auto it = channels.find(channel);
+        if (it == channels.end()) {
+            return VirtualFileSystem::VFS_ERROR_NOT_FOUND;
+        }
+        target = std::move(it->second);
+        channels.erase(it);
+    }
+    vector<DmaDescriptor> pending;
+    {
+        //waits out a burst in flight on this channel
+        lock_guard<mutex> transferLock(target->transferMutex);
+        target->open = false;
+        takePending(*target, pending);
+    }
+    failPending(target->id, pending, VirtualFileSystem::VFS_ERROR_NOT_OPEN);
+    return vfs.close(target->fd, target->generation);
+}
+
+int DmaController::closeChannelsOn(const string& devicePath){
+    vector<int> matching;
+    {
+        lock_guard<mutex> lock(channelsMutex);
+        for (const auto& pair : channels) {
+            if (pair.second->devicePath == devicePath) {
+                matching.push_back(pair.first);
+            }
+        }
+    }
+    int closed = 0;
+    for (int channel : matching) {
+        if (closeChannel(channel) != VirtualFileSystem::VFS_ERROR_NOT_FOUND) {
+            closed++;
+        }
+    }
+    return closed;
+}
+
+//every queued descriptor owns a completion slot until its completion is reaped
+bool DmaController::reserveCompletion(){
+    size_t current = outstanding.load(memory_order_relaxed);
+    do {
+        if (current >= COMPLETION_ENTRIES) {
+            completionBusyCount.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+    } while (!outstanding.compare_exchange_weak(current, current + 1, memory_order_acq_rel));
+    return true;
+}
+
+bool DmaController::submit(int channel, const DmaDescriptor& descriptor){
+    shared_ptr<Channel> target = channelFor(channel);
+    if (!target || !running.load(memory_order_acquire)) {
+        return false;
+    }
+    if (!reserveCompletion()) {
+        return false;
+    }
+    if (!target->ring.push(descriptor)) {
+        outstanding.fetch_sub(1, memory_order_acq_rel);
+        descriptorFullCount.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    submittedCount.fetch_add(1, memory_order_relaxed);
+    {
+        lock_guard<mutex> lock(doorbellMutex);
+        doorbell = true;
+    }
+    doorbellCondition.notify_one();
+    return true;
+}
+
+void DmaController::engineLoop(){
+    vector<shared_ptr<Channel>> active;
+    for (;;) {
+        {
+            unique_lock<mutex> lock(doorbellMutex);
+            doorbellCondition.wait(lock, [this]{ return doorbell || !running.load(memory_order_acquire); });
+            if (!running.load(memory_order_acquire)) {
+                return;
+            }
+            //cleared before draining, anything submitted from here on rings again
+            doorbell = false;
+        }
+
+        //round robin one burst per channel until every ring is empty
+        bool pending = true;
+        while (pending && running.load(memory_order_acquire)) {
+            {
+                lock_guard<mutex> lock(channelsMutex);
+                active.clear();
+                for (const auto& pair : channels) {
+                    active.push_back(pair.second);
+                }
+            }
+            pending = false;
+            for (const auto& channel : active) {
+                if (runBurst(*channel)) {
+                    pending = true;
+                }
+            }
+        }
+        active.clear();
+    }
+}
+
+bool DmaController::runBurst(Channel& channel){
+    unique_lock<mutex> lock(channel.transferMutex);
+    if (!channel.open) {
+        return false;
+    }
+
+    DmaDescriptor descriptors[MAX_BURST];
+    size_t count = 0;
+    while (count < MAX_BURST && channel.ring.pop(descriptors[count])) {
+        count++;
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    VfsIoRequest requests[MAX_BURST];
+    for (size_t index = 0; index < count; index++) {
+        const DmaDescriptor& descriptor = descriptors[index];
+        bool reading = descriptor.direction == DmaDirection::DEVICE_TO_MEMORY;
+        requests[index].fd = channel.fd;
+        requests[index].generation = channel.generation;
+        //same-direction neighbours are coalesced into one driver batch call by submitBatch
+        requests[index].op = reading ? VfsIoOp::READ : VfsIoOp::WRITE;
+        requests[index].buffer = descriptor.buffer;
+        requests[index].size = descriptor.length;
+    }
+    vfs.submitBatch(requests, count);
+    lock.unlock();
+    burstCount.fetch_add(1, memory_order_relaxed);
+
+    for (size_t index = 0; index < count; index++) {
+        int result = requests[index].result;
+        if (result > 0) {
+            bytesCount.fetch_add(static_cast<uint64_t>(result), memory_order_relaxed);
+        }
+        complete(channel.id, descriptors[index].userData, result);
+    }
+    return count == MAX_BURST;
+}
+
+void DmaController::complete(int channel, uint64_t userData, int result){
+    DmaCompletion completion;
+    completion.channel = channel;
+    completion.userData = userData;
+    completion.result = result;
+    //once anything has overflowed, later completions queue behind it to keep their order
+    if (overflowed.load(memory_order_acquire) || !completionRing.push(completion)) {
+        lock_guard<mutex> lock(overflowMutex);
+        overflow.push_back(completion);
+        overflowed.store(true, memory_order_release);
+        completionFullCount.fetch_add(1, memory_order_relaxed);
+    }
+    completedCount.fetch_add(1, memory_order_relaxed);
+    completionEvent.signal();
+
+    lock_guard<mutex> lock(callbackMutex);
+    if (completionCallback) {
+        completionCallback(completion);
+    }
+}
+
+//caller holds the channel's transferMutex
+void DmaController::takePending(Channel& channel, vector<DmaDescriptor>& pending){
+    DmaDescriptor descriptor;
+    while (channel.ring.pop(descriptor)) {
+        pending.push_back(descriptor);
+    }
+}
+
+void DmaController::failPending(int channel, const vector<DmaDescriptor>& pending, int result){
+    for (const auto& descriptor : pending) {
+        complete(channel, descriptor.userData, result);
+    }
+}
+
+void DmaController::flushOverflow(){
+    lock_guard<mutex> lock(overflowMutex);
+    while (!overflow.empty() && completionRing.push(overflow.front())) {
+        overflow.pop_front();
+    }
+    if (overflow.empty()) {
+        overflowed.store(false, memory_order_release);
+    }
+}
+
+bool DmaController::popCompletion(DmaCompletion& completion){
+    bool popped = completionRing.pop(completion);
+    if (overflowed.load(memory_order_acquire)) {
+        flushOverflow();
+        if (!popped) {
+            popped = completionRing.pop(completion);
+        }
+    }
+    if (popped) {
+        size_t current = outstanding.load(memory_order_relaxed);
+        while (current > 0 && !outstanding.compare_exchange_weak(current, current - 1, memory_order_acq_rel)) {}
+    }
+    return popped;
+}
+
+size_t DmaController::reapCompletions(DmaCompletion* completions, size_t maxCount){
+    size_t reaped = 0;
+    while (reaped < maxCount && popCompletion(completions[reaped])) {
+        reaped++;
+    }
+    return reaped;
+}
+
+bool DmaController::waitCompletion(DmaCompletion& completion, chrono::microseconds timeout){
+    auto deadline = chrono::steady_clock::now() + timeout;
+    for (;;) {
+        if (popCompletion(completion)) {
+            return true;
+        }
+        auto now = chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        completionEvent.read(chrono::duration_cast<chrono::microseconds>(deadline - now));
+    }
+}
+
+void DmaController::setCompletionCallback(CompletionCallback callback){
+    lock_guard<mutex> lock(callbackMutex);
+    completionCallback = std::move(callback);
+}
+
+void DmaController::stop(){
+    if (!running.exchange(false)) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(doorbellMutex);
+    }
+    doorbellCondition.notify_all();
+    if (engine.joinable()) {
+        engine.join();
+    }
+
+    unordered_map<int, shared_ptr<Channel>> remaining;
+    {
+        lock_guard<mutex> lock(channelsMutex);
+        remaining.swap(channels);
+    }
+    vector<DmaDescriptor> pending;
+    for (auto& pair : remaining) {
+        Channel& channel = *pair.second;
+        pending.clear();
+        {
+            lock_guard<mutex> transferLock(channel.transferMutex);
+            channel.open = false;
+            takePending(channel, pending);
+        }
+        failPending(channel.id, pending, VirtualFileSystem::VFS_ERROR_NOT_OPEN);
+        vfs.close(channel.fd, channel.generation);
+    }
+}
+
+DmaStats DmaController::getStatistics() const {
+    DmaStats stats;
+    stats.descriptorsSubmitted = submittedCount.load(memory_order_relaxed);
+    stats.descriptorsCompleted = completedCount.load(memory_order_relaxed);
+    stats.bytesTransferred = bytesCount.load(memory_order_relaxed);
+    stats.bursts = burstCount.load(memory_order_relaxed);
+    stats.descriptorRingFull = descriptorFullCount.load(memory_order_relaxed);
+    stats.completionBusy = completionBusyCount.load(memory_order_relaxed);
+    stats.completionRingFull = completionFullCount.load(memory_order_relaxed);
+    lock_guard<mutex> lock(channelsMutex);
+    stats.channels = channels.size();
+    return stats;
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "IoEventCounter.h"
+#include "MpmcRing.h"
+#include "VirtualFileSystem.h"
+
+using namespace std;
+
+enum class DmaDirection {
+    DEVICE_TO_MEMORY,
+    MEMORY_TO_DEVICE
+};
+
+//one entry of a channel's descriptor ring, the buffer belongs to the caller until the completion is reaped
+struct DmaDescriptor {
+    DmaDirection direction = DmaDirection::DEVICE_TO_MEMORY;
+    void* buffer = nullptr;
+    size_t length = 0;
+    uint64_t userData = 0;
+};
+
+//result is bytes moved or a VFS_ERROR_* code
+struct DmaCompletion {
+    int channel = -1;
+    uint64_t userData = 0;
+    int result = 0;
+};
+
+struct DmaStats {
+    uint64_t descriptorsSubmitted;
+    uint64_t descriptorsCompleted;
+    uint64_t bytesTransferred;
+    uint64_t bursts;
+    uint64_t descriptorRingFull;
+    //submit() calls refused because every completion slot was spoken for
+    uint64_t completionBusy;
+    //completions parked on the overflow list because the ring was full
+    uint64_t completionRingFull;
+    size_t channels;
+};
+
+//simulated DMA engine for devices whose driver advertises DRIVER_CAP_DMA
+//each channel owns a descriptor ring on one device; a single engine thread drains the rings in bursts
+//and hands every burst to the driver's batch entry point, so large blocks go straight between the
+//caller's buffer and the driver without per-call overhead or intermediate copies
+//submit() reserves a completion slot per descriptor and refuses once they are all taken, like the
+//async engine; anything that still finds the completion ring full goes to an overflow list, never spun on
+class DmaController{
+    public:
+        static constexpr size_t DESCRIPTOR_ENTRIES = 64;
+        static constexpr size_t COMPLETION_ENTRIES = 256;
+        //descriptors taken from one ring per pass, so a busy channel can't starve the others
+        static constexpr size_t MAX_BURST = 16;
+
+        //runs on the engine thread after the completion is posted, keep it short
+        //(e.g. signal a VFS device event or queue a scheduler command)
+        using CompletionCallback = function<void(const DmaCompletion& completion)>;
+
+    private:
+        struct Channel{
+            int id;
+            int fd;
+            //the open behind fd, bursts and the final close check it so a reused fd number is never touched
+            uint64_t generation;
+            string devicePath;
+            MpmcRing<DmaDescriptor, DESCRIPTOR_ENTRIES> ring;
+            //held by the engine while a burst is in the driver, closeChannel takes it so the fd can't be
+            //reused mid-burst; completions are posted after it is dropped
+            mutex transferMutex;
+            bool open = true;
+        };
+
+        VirtualFileSystem& vfs;
+
+        mutable mutex channelsMutex;
+        unordered_map<int, shared_ptr<Channel>> channels;
+        int nextChannelId;
+
+        MpmcRing<DmaCompletion, COMPLETION_ENTRIES> completionRing;
+        atomic<size_t> outstanding;
+        mutex overflowMutex;
+        deque<DmaCompletion> overflow;
+        atomic<bool> overflowed;
+        IoEventCounter completionEvent;
+        mutex callbackMutex;
+        CompletionCallback completionCallback;
+
+        //doorbell: submit() sets it and wakes the engine thread
+        mutex doorbellMutex;
+        condition_variable doorbellCondition;
+        bool doorbell;
+        thread engine;
+        atomic<bool> running;
+
+        atomic<uint64_t> submittedCount;
+        atomic<uint64_t> completedCount;
+        atomic<uint64_t> bytesCount;
+        atomic<uint64_t> burstCount;
+        atomic<uint64_t> descriptorFullCount;
+        atomic<uint64_t> completionBusyCount;
+        atomic<uint64_t> completionFullCount;
+
+        shared_ptr<Channel> channelFor(int channel) const;
+        void engineLoop();
+        //true if the ring still had descriptors left after the burst
+        bool runBurst(Channel& channel);
+        bool reserveCompletion();
+        void complete(int channel, uint64_t userData, int result);
+        //moves overflowed completions into the ring while it has room
+        void flushOverflow();
+        bool popCompletion(DmaCompletion& completion);
+        //pops whatever is queued on the channel and fails it, the caller then posts the completions
+        void takePending(Channel& channel, vector<DmaDescriptor>& pending);
+        void failPending(int channel, const vector<DmaDescriptor>& pending, int result);
+
+    public:
+        explicit DmaController(VirtualFileSystem& fileSystem);
+        ~DmaController();
+
+        DmaController(const DmaController&) = delete;
+        DmaController& operator = (const DmaController&) = delete;
+
+        //returns a channel id (>= 0) or a VFS_ERROR_* code, VFS_ERROR_ACCESS if the device can't do DMA
+        int openChannel(const string& devicePath);
+        //fails anything still queued on the channel with VFS_ERROR_NOT_OPEN
+        int closeChannel(int channel);
+        //closes every channel on the device, returns how many; the VFS calls it before closing the device
+        int closeChannelsOn(const string& devicePath);
+
+        //queues one descriptor and rings the doorbell, false when the ring is full, every completion
+        //slot is taken (reap first) or the channel is closed
+        bool submit(int channel, const DmaDescriptor& descriptor);
+
+        size_t reapCompletions(DmaCompletion* completions, size_t maxCount);
+        bool waitCompletion(DmaCompletion& completion, chrono::microseconds timeout);
+        //signalled once per posted completion
+        IoEventCounter& getCompletionEvent() {return completionEvent;}
+        void setCompletionCallback(CompletionCallback callback);
+
+        //joins the engine, fails queued descriptors and closes every channel
+        void stop();
+        DmaStats getStatistics() const;
+};
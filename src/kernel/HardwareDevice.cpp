@@ -1,63 +1,194 @@
 #include "HardwareDevice.h"
 #include "Kernel.h"
+#include "DriverTypes.h"
 #include <cstring>
+#include <vector>
 using namespace std;
-HardwareDevice::HardwareDevice(LoadedDriver* loadedDriver, string deviceName, string deviceType)
-    : driver(loadedDriver), name(deviceName), type(deviceType), ready(false) {
+HardwareDevice::HardwareDevice(LoadedDriver* loadedDriver, string deviceName, string deviceType, int instanceIndex)
+    : driver(loadedDriver), name(deviceName), type(deviceType), ready(false), instanceIndex(instanceIndex), instance(nullptr) {
     deviceName = name;
     deviceType = type;
 }
 
-string HardwareDevice::read() {
+int HardwareDevice::read(void* buffer, size_t size) {
     lock_guard<mutex> lock(deviceMutex);
     
     if (!driver || !ready) {
-        return "";
+        return DRIVER_STATUS_NOT_READY;
     }
     
     try {
-        char buffer[1024] = {0};
-        
-        typedef int(*DriverReadFunc)(void*, size_t);
-        DriverReadFunc readFunc = reinterpret_cast<DriverReadFunc>(
-            reinterpret_cast<void*>(driver->functions.driverRead)
-        );
-        
-        int result = readFunc(buffer, sizeof(buffer));
-        
-        if (result >= 0) {
-            return string(buffer, result);
+        int result;
+        if (instance) {
+            typedef int(*DriverInstanceReadFunc)(DriverInstance*, void*, size_t);
+            DriverInstanceReadFunc readFunc = reinterpret_cast<DriverInstanceReadFunc>(
+                reinterpret_cast<void*>(driver->functions.driverInstanceRead)
+            );
+            result = readFunc(instance, buffer, size);
         }
-        
-        return "";
+        else{
+            typedef int(*DriverReadFunc)(void*, size_t);
+            DriverReadFunc readFunc = reinterpret_cast<DriverReadFunc>(
+                reinterpret_cast<void*>(driver->functions.driverRead)
+            );
+            result = readFunc(buffer, size);
+        }
+        //drivers report the bytes they filled, which may be fewer than size
+        return result;
     } catch (const exception& e) {
         Kernel::getInstance().getLogger().log(MessageType::ERRORS, 
             "Read error for device " + name + ": " + e.what());
-        return "";
+        return DRIVER_STATUS_ERROR;
     }
 }
 
-bool HardwareDevice::write(const string& data) {
+int HardwareDevice::write(const void* buffer, size_t size) {
     lock_guard<mutex> lock(deviceMutex);
     
     if (!driver || !ready) {
-        return false;
+        return DRIVER_STATUS_NOT_READY;
     }
     
     try {
-        typedef int(*DriverWriteFunc)(const void*, size_t);
-        DriverWriteFunc writeFunc = reinterpret_cast<DriverWriteFunc>(
-            reinterpret_cast<void*>(driver->functions.driverWrite)
-        );
-        
-        int result = writeFunc(data.c_str(), data.length());
-        return result >= 0;
+        int result;
+        if (instance) {
+            typedef int(*DriverInstanceWriteFunc)(DriverInstance*, const void*, size_t);
+            DriverInstanceWriteFunc writeFunc = reinterpret_cast<DriverInstanceWriteFunc>(
+                reinterpret_cast<void*>(driver->functions.driverInstanceWrite)
+            );
+            result = writeFunc(instance, buffer, size);
+        }
+        else{
+            typedef int(*DriverWriteFunc)(const void*, size_t);
+            DriverWriteFunc writeFunc = reinterpret_cast<DriverWriteFunc>(
+                reinterpret_cast<void*>(driver->functions.driverWrite)
+            );
+            result = writeFunc(buffer, size);
+        }
+        //drivers report DRIVER_STATUS_SUCCESS rather than a count when they take the whole buffer
+        if (result == DRIVER_STATUS_SUCCESS) {
+            return static_cast<int>(size);
+        }
+        return result;
         
     } catch (const exception& e) {
         Kernel::getInstance().getLogger().log(MessageType::ERRORS, 
             "Write error for device " + name + ": " + e.what());
+        return DRIVER_STATUS_ERROR;
+    }
+}
+
+FunctionPtr HardwareDevice::batchFunction(bool writing) const {
+    if (!driver) {
+        return nullptr;
+    }
+    //the plain batch calls address the driver's default device, v2 instances need the per-instance ones
+    if (instance) {
+        return writing ? driver->functions.driverInstanceWriteBatch : driver->functions.driverInstanceReadBatch;
+    }
+    return writing ? driver->functions.driverWriteBatch : driver->functions.driverReadBatch;
+}
+
+//one lock and one ABI crossing for the whole batch, false when the driver has no batch call
+bool HardwareDevice::transferBatch(bool writing, const IoVec* iov, int* results, int count) {
+    FunctionPtr function = batchFunction(writing);
+    if (!function || count <= 0) {
         return false;
     }
+    lock_guard<mutex> lock(deviceMutex);
+
+    if (!ready) {
+        for (int i = 0; i < count; i++) {
+            results[i] = DRIVER_STATUS_NOT_READY;
+        }
+        return true;
+    }
+
+    static constexpr int STACK_DESCRIPTORS = 16;
+    DriverIoDescriptor stackDescriptors[STACK_DESCRIPTORS];
+    vector<DriverIoDescriptor> heapDescriptors;
+    DriverIoDescriptor* descriptors = stackDescriptors;
+    if (count > STACK_DESCRIPTORS) {
+        heapDescriptors.resize(count);
+        descriptors = heapDescriptors.data();
+    }
+    for (int i = 0; i < count; i++) {
+        descriptors[i].buffer = iov[i].base;
+        descriptors[i].size = iov[i].length;
+        descriptors[i].result = DRIVER_STATUS_ERROR;
+    }
+
+    int status;
+    try {
+        if (instance) {
+            typedef int(*DriverInstanceBatchFunc)(DriverInstance*, DriverIoDescriptor*, size_t);
+            DriverInstanceBatchFunc batchFunc = reinterpret_cast<DriverInstanceBatchFunc>(
+                reinterpret_cast<void*>(function)
+            );
+            status = batchFunc(instance, descriptors, static_cast<size_t>(count));
+        }
+        else{
+            typedef int(*DriverBatchFunc)(DriverIoDescriptor*, size_t);
+            DriverBatchFunc batchFunc = reinterpret_cast<DriverBatchFunc>(
+                reinterpret_cast<void*>(function)
+            );
+            status = batchFunc(descriptors, static_cast<size_t>(count));
+        }
+    } catch (const exception& e) {
+        Kernel::getInstance().getLogger().log(MessageType::ERRORS, 
+            "Batch " + string(writing ? "write" : "read") + " error for device " + name + ": " + e.what());
+        status = DRIVER_STATUS_ERROR;
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i] = status == DRIVER_STATUS_SUCCESS ? descriptors[i].result : status;
+    }
+    return true;
+}
+
+//same accounting as Device::readv, the prefix of segments that moved in full plus the first short one
+int HardwareDevice::gatherResults(const IoVec* iov, const int* results, int count) const {
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        if (results[i] < 0) {
+            return total > 0 ? total : results[i];
+        }
+        total += results[i];
+        if (static_cast<size_t>(results[i]) < iov[i].length) {
+            break;
+        }
+    }
+    return total;
+}
+
+void HardwareDevice::readBatch(const IoVec* iov, int* results, int count) {
+    if (!transferBatch(false, iov, results, count)) {
+        Device::readBatch(iov, results, count);
+    }
+}
+
+void HardwareDevice::writeBatch(const IoVec* iov, int* results, int count) {
+    if (!transferBatch(true, iov, results, count)) {
+        Device::writeBatch(iov, results, count);
+    }
+}
+
+int HardwareDevice::readv(const IoVec* iov, int iovcnt) {
+    if (!batchFunction(false) || iovcnt <= 0) {
+        return Device::readv(iov, iovcnt);
+    }
+    vector<int> results(iovcnt);
+    transferBatch(false, iov, results.data(), iovcnt);
+    return gatherResults(iov, results.data(), iovcnt);
+}
+
+int HardwareDevice::writev(const IoVec* iov, int iovcnt) {
+    if (!batchFunction(true) || iovcnt <= 0) {
+        return Device::writev(iov, iovcnt);
+    }
+    vector<int> results(iovcnt);
+    transferBatch(true, iov, results.data(), iovcnt);
+    return gatherResults(iov, results.data(), iovcnt);
 }
 
 string HardwareDevice::getName() const {
@@ -101,6 +232,14 @@ bool HardwareDevice::configure(int parameter, int value) {
     }
     
     try {
+        if (instance) {
+            typedef int(*DriverInstanceConfigureFunc)(DriverInstance*, int, int);
+            DriverInstanceConfigureFunc configFunc = reinterpret_cast<DriverInstanceConfigureFunc>(
+                reinterpret_cast<void*>(driver->functions.driverInstanceConfigure)
+            );
+            return configFunc(instance, parameter, value) == 0;
+        }
+
         typedef int(*DriverConfigureFunc)(int, int);
         DriverConfigureFunc configFunc = reinterpret_cast<DriverConfigureFunc>(
             reinterpret_cast<void*>(driver->functions.driverConfigure)
@@ -116,6 +255,17 @@ bool HardwareDevice::configure(int parameter, int value) {
     }
 }
 
+bool HardwareDevice::supportsDma() const {
+    if (!driver || !driver->functions.driverGetCapabilities) {
+        return false;
+    }
+    typedef int(*DriverCapabilitiesFunc)();
+    DriverCapabilitiesFunc capFunc = reinterpret_cast<DriverCapabilitiesFunc>(
+        reinterpret_cast<void*>(driver->functions.driverGetCapabilities)
+    );
+    return (capFunc() & DRIVER_CAP_DMA) != 0;
+}
+
 bool HardwareDevice::initialise() {
     lock_guard<mutex> lock(deviceMutex);
     
@@ -134,6 +284,19 @@ bool HardwareDevice::initialise() {
         );
         
         bool result = initFunc();
+        //driverInit brings up the shared hardware once, each v2 device then opens its own instance
+        if (result && driver->abiVersion >= 2) {
+            typedef DriverInstance*(*DriverOpenInstanceFunc)(int);
+            DriverOpenInstanceFunc openFunc = reinterpret_cast<DriverOpenInstanceFunc>(
+                reinterpret_cast<void*>(driver->functions.driverOpenInstance)
+            );
+            instance = openFunc(instanceIndex);
+            if (!instance) {
+                Kernel::getInstance().getLogger().log(MessageType::ERRORS,
+                    "Driver refused instance " + to_string(instanceIndex) + " for device " + name);
+                return false;
+            }
+        }
         if (result) {
             isInitialised = true;
             ready = true;
@@ -158,12 +321,22 @@ void HardwareDevice::cleanup() {
     }
     
     try {
-        typedef void(*DriverCleanupFunc)();
-        DriverCleanupFunc cleanupFunc = reinterpret_cast<DriverCleanupFunc>(
-            reinterpret_cast<void*>(driver->functions.driverCleanup)
-        );
-        
-        cleanupFunc();
+        //v2 instances share the driver, only release ours; the loader runs driverCleanup on unload
+        if (instance) {
+            typedef void(*DriverCloseInstanceFunc)(DriverInstance*);
+            DriverCloseInstanceFunc closeFunc = reinterpret_cast<DriverCloseInstanceFunc>(
+                reinterpret_cast<void*>(driver->functions.driverCloseInstance)
+            );
+            closeFunc(instance);
+            instance = nullptr;
+        }
+        else{
+            typedef void(*DriverCleanupFunc)();
+            DriverCleanupFunc cleanupFunc = reinterpret_cast<DriverCleanupFunc>(
+                reinterpret_cast<void*>(driver->functions.driverCleanup)
+            );
+            cleanupFunc();
+        }
         isInitialised = false;
         ready = false;
         
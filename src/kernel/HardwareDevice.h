@@ -1,6 +1,7 @@
 #pragma once
 #include "Device.h"
 #include "DllLoader.h"
+#include "DriverTypes.h"
 #include <string>
 
 class HardwareDevice : public Device {
@@ -8,17 +9,33 @@ class HardwareDevice : public Device {
     std::string name;
     std::string type;
     bool ready;
+    //v2 drivers: which instance this device is and the context the driver handed back for it
+    int instanceIndex;
+    DriverInstance* instance;
+
+    //null when the driver has no batch entry point for that direction or this is a v2 instance
+    FunctionPtr batchFunction(bool writing) const;
+    bool transferBatch(bool writing, const IoVec* iov, int* results, int count);
+    int gatherResults(const IoVec* iov, const int* results, int count) const;
 public:
-    HardwareDevice(LoadedDriver* loadedDriver, std::string deviceName, std::string deviceType);
-    std::string read() override;
-    bool write(const std::string& data) override;
+    HardwareDevice(LoadedDriver* loadedDriver, std::string deviceName, std::string deviceType, int instanceIndex = 0);
+    using Device::read;
+    using Device::write;
+    int read(void* buffer, size_t size) override;
+    int write(const void* buffer, size_t size) override;
+    int readv(const IoVec* iov, int iovcnt) override;
+    int writev(const IoVec* iov, int iovcnt) override;
+    void readBatch(const IoVec* iov, int* results, int count) override;
+    void writeBatch(const IoVec* iov, int* results, int count) override;
     std::string getName() const override;
     bool isReady() const override;
     std::string getType() const override;
     std::string getStatus() const override;
     bool configure(int parameter, int value) override;
+    bool supportsDma() const override;
     bool initialise() override;
     void cleanup() override;
     LoadedDriver* getDriver() const { return driver; }
+    int getInstanceIndex() const { return instanceIndex; }
     void setReady(bool state) { ready = state; }
 };
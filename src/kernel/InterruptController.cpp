@@ -0,0 +1,501 @@
+#include "InterruptController.h"
+#include "Kernel.h"
+#include "Logger.h"
+#include "../scheduler/Scheduler.h"
+#include <algorithm>
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+using namespace std;
+
+static uint64_t microsecondsSince(chrono::steady_clock::time_point from){
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - from).count());
+}
+
+static string formatPercentiles(const LatencyHistogram::Snapshot& histogram){
+    return to_string(histogram.percentile(50.0)) + "/" +
+           to_string(histogram.percentile(99.0)) + "/" +
+           to_string(histogram.percentile(99.9)) + "/" +
+           to_string(histogram.maxValue) + "us";
+}
+
+InterruptController::InterruptController(Scheduler& kernelScheduler)
+    : scheduler(kernelScheduler), nextActionId(0), pendingLines(0), isrSleeping(false), running(true) {
+    for (int irq = 0; irq < MAX_IRQS; irq++) {
+        lines[irq] = make_shared<IrqLine>();
+        lines[irq]->irq = irq;
+        lines[irq]->controller = this;
+    }
+}
+
+InterruptController::~InterruptController(){
+    stop();
+}
+
+bool InterruptController::initialise(){
+    if (isrThread.joinable()) {
+        return true;
+    }
+    if (!running.load()) {
+        return false;
+    }
+    //bottom halves are queued from the ISR thread, their thread must already be running
+    scheduler.startBottomHalves();
+    isrThread = thread(&InterruptController::isrLoop, this);
+    return true;
+}
+
+void InterruptController::stop(){
+    {
+        lock_guard<mutex> lock(isrMutex);
+        if (!running.exchange(false)) {
+            return;
+        }
+        isrCondition.notify_one();
+    }
+    if (isrThread.joinable()) {
+        isrThread.join();
+    }
+    IrqEvent event;
+    for (auto& line : lines) {
+        while (line->queue.pop(event)) {}
+        line->maskedCount.store(0);
+        line->maskedSince.store(0);
+    }
+}
+
+//the ISR thread outranks the clock and the scheduler workers when the host allows it
+void InterruptController::raisePriority(){
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#else
+    sched_param param{};
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+        Kernel::getInstance().getLogger().log(MessageType::INFO,
+            "ISR thread running at normal priority (no realtime scheduling permission)");
+    }
+#endif
+}
+
+int InterruptController::allocateIrq(const string& name){
+    lock_guard<mutex> lock(allocationMutex);
+    for (auto& line : lines) {
+        if (line->allocated.load(memory_order_relaxed)) {
+            continue;
+        }
+        {
+            lock_guard<mutex> actionsLock(line->actionsMutex);
+            line->name = name;
+            resetModerationState(*line);
+        }
+        line->raised = 0;
+        line->delivered = 0;
+        line->coalesced = 0;
+        line->polls = 0;
+        line->pollModeEntries = 0;
+        line->handled = 0;
+        line->unhandled = 0;
+        line->dropped = 0;
+        line->bottomHalves = 0;
+        line->dispatchLatency.reset();
+        line->bottomHalfLatency.reset();
+        line->allocated.store(true, memory_order_release);
+        return line->irq;
+    }
+    return -1;
+}
+
+void InterruptController::freeIrq(int irq){
+    if (irq < 0 || irq >= MAX_IRQS) {
+        return;
+    }
+    lock_guard<mutex> lock(allocationMutex);
+    IrqLine& line = *lines[irq];
+    line.allocated.store(false, memory_order_release);
+    {
+        lock_guard<mutex> actionsLock(line.actionsMutex);
+        line.actions.clear();
+        line.name.clear();
+        resetModerationState(line);
+    }
+    IrqEvent event;
+    while (line.queue.pop(event)) {}
+}
+
+//caller holds the line's actionsMutex
+void InterruptController::resetModerationState(IrqLine& line){
+    line.moderation = IrqModeration();
+    line.heldCount = 0;
+    line.fullBatches = 0;
+    line.lastDelivery = chrono::steady_clock::time_point();
+    line.polling.store(false);
+    line.maskedCount.store(0);
+    line.maskedSince.store(0);
+}
+
+int InterruptController::requestIrq(int irq, TopHalf topHalf, BottomHalf bottomHalf){
+    if (irq < 0 || irq >= MAX_IRQS || !lines[irq]->allocated.load(memory_order_acquire)) {
+        return -1;
+    }
+    IrqLine& line = *lines[irq];
+    lock_guard<mutex> lock(line.actionsMutex);
+    int id = nextActionId++;
+    line.actions.push_back(Action{id, std::move(topHalf), std::move(bottomHalf)});
+    return id;
+}
+
+bool InterruptController::releaseIrq(int irq, int actionId){
+    if (irq < 0 || irq >= MAX_IRQS) {
+        return false;
+    }
+    IrqLine& line = *lines[irq];
+    lock_guard<mutex> lock(line.actionsMutex);
+    auto it = find_if(line.actions.begin(), line.actions.end(), [actionId](const Action& action){
+        return action.id == actionId;
+    });
+    if (it == line.actions.end()) {
+        return false;
+    }
+    line.actions.erase(it);
+    return true;
+}
+
+int InterruptController::findIrq(const string& name) const {
+    for (const auto& line : lines) {
+        if (!line->allocated.load(memory_order_acquire)) {
+            continue;
+        }
+        lock_guard<mutex> lock(line->actionsMutex);
+        if (line->name == name) {
+            return line->irq;
+        }
+    }
+    return -1;
+}
+
+bool InterruptController::setModeration(int irq, const IrqModeration& moderation){
+    if (irq < 0 || irq >= MAX_IRQS || !lines[irq]->allocated.load(memory_order_acquire)) {
+        return false;
+    }
+    IrqLine& line = *lines[irq];
+    {
+        lock_guard<mutex> lock(line.actionsMutex);
+        line.moderation = moderation;
+        //a batch can't be larger than the queue, or a full one would never be seen
+        line.moderation.maxEvents = min<uint32_t>(max<uint32_t>(line.moderation.maxEvents, 1),
+                                                  static_cast<uint32_t>(QUEUE_ENTRIES));
+        if (line.moderation.pollInterval <= chrono::microseconds(0)) {
+            line.moderation.pollInterval = chrono::microseconds(1);
+        }
+    }
+    //held raises may be due under the new limits
+    wake(irq);
+    return true;
+}
+
+IrqModeration InterruptController::getModeration(int irq) const {
+    if (irq < 0 || irq >= MAX_IRQS) {
+        return IrqModeration();
+    }
+    lock_guard<mutex> lock(lines[irq]->actionsMutex);
+    return lines[irq]->moderation;
+}
+
+bool InterruptController::raise(int irq, uint32_t data){
+    if (irq < 0 || irq >= MAX_IRQS || !running.load(memory_order_acquire)) {
+        return false;
+    }
+    IrqLine& line = *lines[irq];
+    if (!line.allocated.load(memory_order_acquire)) {
+        return false;
+    }
+    auto now = chrono::steady_clock::now();
+    if (line.polling.load()) {
+        //masked: a coalesced delivery only carries the count and the latest data, so that is all
+        //that is kept; the next poll picks it up
+        line.maskedData.store(data, memory_order_relaxed);
+        int64_t none = 0;
+        if (line.maskedSince.load(memory_order_relaxed) == 0) {
+            line.maskedSince.compare_exchange_strong(none, now.time_since_epoch().count(), memory_order_relaxed);
+        }
+        line.maskedCount.fetch_add(1);
+        line.raised.fetch_add(1, memory_order_relaxed);
+        //the line was unmasked under us and may already have been looked at, make sure it is again
+        if (!line.polling.load()) {
+            wake(irq);
+        }
+        return true;
+    }
+    IrqEvent event;
+    event.irq = irq;
+    event.data = data;
+    event.raisedAt = now;
+    if (!line.queue.push(event)) {
+        line.dropped.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    line.raised.fetch_add(1, memory_order_relaxed);
+    wake(irq);
+    return true;
+}
+
+void InterruptController::wake(int irq){
+    pendingLines.fetch_or(uint64_t(1) << irq);
+    //the mutex is only touched when the ISR thread is (about to be) asleep
+    if (isrSleeping.load()) {
+        lock_guard<mutex> lock(isrMutex);
+        isrCondition.notify_one();
+    }
+}
+
+void InterruptController::driverRaise(void* context, uint32_t data){
+    IrqLine* line = static_cast<IrqLine*>(context);
+    if (line) {
+        line->controller->raise(line->irq, data);
+    }
+}
+
+void* InterruptController::getDriverContext(int irq){
+    if (irq < 0 || irq >= MAX_IRQS) {
+        return nullptr;
+    }
+    return lines[irq].get();
+}
+
+void InterruptController::isrLoop(){
+    raisePriority();
+    const auto never = chrono::steady_clock::time_point::max();
+    while (running.load()) {
+        uint64_t pending = pendingLines.exchange(0);
+        //lowest line first, like a fixed-priority controller; lines without a raise still get
+        //looked at so held batches and polled lines are serviced when their time comes
+        auto wakeAt = never;
+        for (int irq = 0; irq < MAX_IRQS; irq++) {
+            if (!lines[irq]->allocated.load(memory_order_acquire)) {
+                continue;
+            }
+            wakeAt = min(wakeAt, service(lines[irq], (pending & (uint64_t(1) << irq)) != 0));
+        }
+
+        unique_lock<mutex> lock(isrMutex);
+        isrSleeping.store(true);
+        auto woken = [this]{ return pendingLines.load() != 0 || !running.load(); };
+        if (wakeAt == never) {
+            isrCondition.wait(lock, woken);
+        }
+        else{
+            isrCondition.wait_until(lock, wakeAt, woken);
+        }
+        isrSleeping.store(false);
+    }
+}
+
+chrono::steady_clock::time_point InterruptController::service(const shared_ptr<IrqLine>& line, bool raised){
+    const auto never = chrono::steady_clock::time_point::max();
+    IrqLine& irqLine = *line;
+    lock_guard<mutex> lock(irqLine.actionsMutex);
+    const IrqModeration& moderation = irqLine.moderation;
+    auto now = chrono::steady_clock::now();
+    IrqEvent event;
+
+    if (irqLine.polling.load()) {
+        if (now < irqLine.nextPoll) {
+            return irqLine.nextPoll;
+        }
+        //one poll takes everything raised since the last one as a single delivery: what was still
+        //queued when the line was masked, then the raises counted since
+        uint32_t polled = 0;
+        while (polled < QUEUE_ENTRIES && irqLine.queue.pop(event)) {
+            hold(irqLine, event);
+            polled++;
+        }
+        polled += holdMasked(irqLine);
+        irqLine.polls.fetch_add(1, memory_order_relaxed);
+        if (irqLine.heldCount > 0) {
+            deliver(line, now);
+        }
+        if (polled >= moderation.maxEvents && moderation.pollAfterFullBatches > 0) {
+            irqLine.nextPoll = now + moderation.pollInterval;
+            return irqLine.nextPoll;
+        }
+        //load has dropped, unmask and look again in case a raise slipped in while masked
+        irqLine.polling.store(false);
+        irqLine.fullBatches = 0;
+        pendingLines.fetch_or(uint64_t(1) << irqLine.irq);
+        return never;
+    }
+
+    //raises that raced the unmask were counted rather than queued
+    if (holdMasked(irqLine) > 0 && deliveryDue(irqLine, now)) {
+        deliver(line, now);
+    }
+
+    if (raised) {
+        //at most one queue's worth per pass so a storm on one line can't lock out the others
+        size_t budget = QUEUE_ENTRIES;
+        while (budget > 0 && irqLine.queue.pop(event)) {
+            budget--;
+            hold(irqLine, event);
+            if (!deliveryDue(irqLine, now)) {
+                continue;
+            }
+            bool full = moderation.maxEvents > 1 && irqLine.heldCount >= moderation.maxEvents;
+            deliver(line, now);
+            if (!full) {
+                irqLine.fullBatches = 0;
+                continue;
+            }
+            if (moderation.pollAfterFullBatches > 0 && ++irqLine.fullBatches >= moderation.pollAfterFullBatches) {
+                //sustained load: mask the line, whatever is still queued goes to the first poll
+                irqLine.polling.store(true);
+                irqLine.pollModeEntries.fetch_add(1, memory_order_relaxed);
+                irqLine.nextPoll = now + moderation.pollInterval;
+                return irqLine.nextPoll;
+            }
+        }
+        if (budget == 0) {
+            pendingLines.fetch_or(uint64_t(1) << irqLine.irq);
+        }
+    }
+
+    //held raises whose delay has run out
+    if (irqLine.heldCount > 0 && deliveryDue(irqLine, now)) {
+        deliver(line, now);
+        irqLine.fullBatches = 0;
+    }
+    return irqLine.heldCount > 0 ? irqLine.lastDelivery + moderation.maxDelay : never;
+}
+
+//caller holds the line's actionsMutex
+void InterruptController::hold(IrqLine& line, const IrqEvent& event){
+    if (line.heldCount == 0) {
+        line.heldEvent = event;
+    }
+    else{
+        line.heldEvent.data = event.data;
+    }
+    line.heldCount++;
+}
+
+//caller holds the line's actionsMutex
+uint32_t InterruptController::holdMasked(IrqLine& line){
+    uint32_t count = line.maskedCount.exchange(0);
+    if (count == 0) {
+        return 0;
+    }
+    int64_t since = line.maskedSince.exchange(0, memory_order_relaxed);
+    IrqEvent event;
+    event.irq = line.irq;
+    event.data = line.maskedData.load(memory_order_relaxed);
+    //a raise can land between the two exchanges, then its timestamp waits for the next poll
+    event.raisedAt = since != 0 ? chrono::steady_clock::time_point(chrono::steady_clock::duration(since))
+                                : chrono::steady_clock::now();
+    hold(line, event);
+    line.heldCount += count - 1;
+    return count;
+}
+
+bool InterruptController::deliveryDue(const IrqLine& line, chrono::steady_clock::time_point now) const {
+    return line.heldCount >= line.moderation.maxEvents || now >= line.lastDelivery + line.moderation.maxDelay;
+}
+
+//caller holds the line's actionsMutex
+void InterruptController::deliver(const shared_ptr<IrqLine>& line, chrono::steady_clock::time_point now){
+    IrqEvent event = line->heldEvent;
+    event.count = line->heldCount;
+    line->heldCount = 0;
+    line->lastDelivery = now;
+    line->delivered.fetch_add(1, memory_order_relaxed);
+    line->coalesced.fetch_add(event.count - 1, memory_order_relaxed);
+    line->dispatchLatency.record(microsecondsSince(event.raisedAt));
+
+    bool claimed = false;
+    for (const auto& action : line->actions) {
+        IrqResult result = IrqResult::WAKE_BOTTOM_HALF;
+        if (action.topHalf) {
+            try {
+                result = action.topHalf(event);
+            } catch (const exception& e) {
+                Kernel::getInstance().getLogger().log(MessageType::ERRORS,
+                    "IRQ " + to_string(event.irq) + " handler threw: " + e.what());
+                continue;
+            }
+        }
+        if (result == IrqResult::NONE) {
+            continue;
+        }
+        claimed = true;
+        if (result == IrqResult::WAKE_BOTTOM_HALF && action.bottomHalf) {
+            line->bottomHalves.fetch_add(1, memory_order_relaxed);
+            shared_ptr<IrqLine> owner = line;
+            BottomHalf bottomHalf = action.bottomHalf;
+            scheduler.queueBottomHalf([owner, bottomHalf, event]{
+                owner->bottomHalfLatency.record(microsecondsSince(event.raisedAt));
+                bottomHalf(event);
+            });
+        }
+    }
+    (claimed ? line->handled : line->unhandled).fetch_add(1, memory_order_relaxed);
+}
+
+IrqStats InterruptController::getStatistics(int irq) const {
+    IrqStats stats{};
+    if (irq < 0 || irq >= MAX_IRQS) {
+        stats.irq = -1;
+        return stats;
+    }
+    IrqLine& line = *lines[irq];
+    stats.irq = irq;
+    {
+        lock_guard<mutex> lock(line.actionsMutex);
+        stats.name = line.name;
+    }
+    stats.raised = line.raised.load(memory_order_relaxed);
+    stats.delivered = line.delivered.load(memory_order_relaxed);
+    stats.coalesced = line.coalesced.load(memory_order_relaxed);
+    stats.polls = line.polls.load(memory_order_relaxed);
+    stats.pollModeEntries = line.pollModeEntries.load(memory_order_relaxed);
+    stats.polling = line.polling.load(memory_order_relaxed);
+    stats.handled = line.handled.load(memory_order_relaxed);
+    stats.unhandled = line.unhandled.load(memory_order_relaxed);
+    stats.dropped = line.dropped.load(memory_order_relaxed);
+    stats.bottomHalves = line.bottomHalves.load(memory_order_relaxed);
+    stats.dispatchLatency = line.dispatchLatency.snapshot();
+    stats.bottomHalfLatency = line.bottomHalfLatency.snapshot();
+    return stats;
+}
+
+vector<IrqStats> InterruptController::getAllStatistics() const {
+    vector<IrqStats> all;
+    for (int irq = 0; irq < MAX_IRQS; irq++) {
+        if (lines[irq]->allocated.load(memory_order_acquire)) {
+            all.push_back(getStatistics(irq));
+        }
+    }
+    return all;
+}
+
+void InterruptController::displayStatistics() const {
+    Logger& logger = Kernel::getInstance().getLogger();
+    logger.log(MessageType::HEADER, "Interrupt Statistics");
+    for (const auto& stats : getAllStatistics()) {
+        logger.log(MessageType::STATUS, "IRQ " + to_string(stats.irq) + " (" + stats.name + "): raised " +
+                                        to_string(stats.raised) + ", delivered " + to_string(stats.delivered) +
+                                        ", coalesced " + to_string(stats.coalesced) + ", dropped " + to_string(stats.dropped));
+        logger.log(MessageType::STATUS, "  handled " + to_string(stats.handled) + ", unhandled " +
+                                        to_string(stats.unhandled) + ", bottom halves " + to_string(stats.bottomHalves) +
+                                        ", polls " + to_string(stats.polls) + " (entered polling " +
+                                        to_string(stats.pollModeEntries) + "x" + (stats.polling ? ", polling now)" : ")"));
+        if (stats.dispatchLatency.totalCount > 0) {
+            logger.log(MessageType::STATUS, "  dispatch p50/p99/p99.9/max: " + formatPercentiles(stats.dispatchLatency));
+        }
+        if (stats.bottomHalfLatency.totalCount > 0) {
+            logger.log(MessageType::STATUS, "  bottom half p50/p99/p99.9/max: " + formatPercentiles(stats.bottomHalfLatency));
+        }
+    }
+}
@@ -0,0 +1,195 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MpmcRing.h"
+#include "../scheduler/LatencyHistogram.h"
+
+using namespace std;
+
+class Scheduler;
+
+//one delivery of an IRQ line, data is whatever the driver passed (pin number, status bits...)
+//when raises are coalesced, count says how many this delivery stands for, data is from the
+//latest one and raisedAt from the oldest
+struct IrqEvent {
+    int irq = -1;
+    uint32_t data = 0;
+    uint32_t count = 1;
+    chrono::steady_clock::time_point raisedAt;
+};
+
+//per-line interrupt moderation, the defaults deliver every raise on its own
+struct IrqModeration {
+    //deliver as soon as this many raises have collected, at most QUEUE_ENTRIES
+    uint32_t maxEvents = 1;
+    //otherwise hold raises until this long after the previous delivery; a line that has been
+    //quiet for longer delivers immediately, so this only adds latency under load
+    chrono::microseconds maxDelay{0};
+    //after this many back-to-back deliveries triggered by maxEvents the line is masked and
+    //polled every pollInterval instead (NAPI style), 0 never polls; while masked, raises are only
+    //counted, so a storm never overruns the queue
+    uint32_t pollAfterFullBatches = 0;
+    chrono::microseconds pollInterval{1000};
+};
+
+enum class IrqResult {
+    //not this handler's device, lets shared lines try the next one
+    NONE,
+    HANDLED,
+    //handled, and the action's bottom half should run on the scheduler
+    WAKE_BOTTOM_HALF
+};
+
+struct IrqStats {
+    int irq;
+    string name;
+    uint64_t raised;
+    //top-half runs, each covers one or more raises
+    uint64_t delivered;
+    //raises folded into another delivery
+    uint64_t coalesced;
+    uint64_t handled;
+    //delivered with no handler claiming it
+    uint64_t unhandled;
+    //lost because the line's queue was full (only while unmasked, a masked line just counts raises)
+    uint64_t dropped;
+    uint64_t bottomHalves;
+    uint64_t polls;
+    uint64_t pollModeEntries;
+    bool polling;
+    //oldest raise of a delivery to its top half, us
+    LatencyHistogram::Snapshot dispatchLatency;
+    //raise to bottom half start, us
+    LatencyHistogram::Snapshot bottomHalfLatency;
+};
+
+//virtual interrupt controller
+//raise() is lock-free: the event goes onto the line's own ring and the line's bit is set in a pending
+//mask; one high-priority ISR thread drains the pending lines and runs their top halves, and anything
+//that needs more work than that is deferred to the scheduler as a bottom half
+//lines can be moderated so an event storm costs a bounded number of deliveries per second
+class InterruptController{
+    public:
+        static constexpr int MAX_IRQS = 64;
+        static constexpr size_t QUEUE_ENTRIES = 256;
+
+        //top halves run on the ISR thread and must not block
+        using TopHalf = function<IrqResult(const IrqEvent& event)>;
+        using BottomHalf = function<void(const IrqEvent& event)>;
+
+    private:
+        struct Action{
+            int id;
+            TopHalf topHalf;
+            BottomHalf bottomHalf;
+        };
+
+        struct IrqLine{
+            int irq = -1;
+            InterruptController* controller = nullptr;
+            atomic<bool> allocated{false};
+            MpmcRing<IrqEvent, QUEUE_ENTRIES> queue;
+
+            //guards everything below up to the counters; the ISR thread holds it while servicing
+            //the line, so it is only contended while handlers or moderation are being changed
+            mutex actionsMutex;
+            string name;
+            vector<Action> actions;
+            IrqModeration moderation;
+
+            //raises collected but not yet delivered
+            uint32_t heldCount = 0;
+            IrqEvent heldEvent;
+            chrono::steady_clock::time_point lastDelivery;
+            uint32_t fullBatches = 0;
+            chrono::steady_clock::time_point nextPoll;
+            //masked: raise() only bumps maskedCount and maskedData without waking the ISR thread,
+            //which polls the line instead
+            atomic<bool> polling{false};
+            atomic<uint32_t> maskedCount{0};
+            atomic<uint32_t> maskedData{0};
+            //steady_clock ticks of the first masked raise since the last poll, 0 when none
+            atomic<int64_t> maskedSince{0};
+
+            atomic<uint64_t> raised{0};
+            atomic<uint64_t> delivered{0};
+            atomic<uint64_t> coalesced{0};
+            atomic<uint64_t> polls{0};
+            atomic<uint64_t> pollModeEntries{0};
+            atomic<uint64_t> handled{0};
+            atomic<uint64_t> unhandled{0};
+            atomic<uint64_t> dropped{0};
+            atomic<uint64_t> bottomHalves{0};
+            LatencyHistogram dispatchLatency;
+            LatencyHistogram bottomHalfLatency;
+        };
+
+        Scheduler& scheduler;
+        //shared so a queued bottom half can still record into its line after the line is freed
+        shared_ptr<IrqLine> lines[MAX_IRQS];
+        mutex allocationMutex;
+        atomic<int> nextActionId;
+
+        atomic<uint64_t> pendingLines;
+        mutex isrMutex;
+        condition_variable isrCondition;
+        atomic<bool> isrSleeping;
+        atomic<bool> running;
+        thread isrThread;
+
+        void isrLoop();
+        //returns when the line next needs servicing without a raise, time_point::max() if never
+        chrono::steady_clock::time_point service(const shared_ptr<IrqLine>& line, bool raised);
+        void hold(IrqLine& line, const IrqEvent& event);
+        //folds the raises counted while masked into the held batch, returns how many there were
+        uint32_t holdMasked(IrqLine& line);
+        bool deliveryDue(const IrqLine& line, chrono::steady_clock::time_point now) const;
+        void deliver(const shared_ptr<IrqLine>& line, chrono::steady_clock::time_point now);
+        void resetModerationState(IrqLine& line);
+        void wake(int irq);
+        void raisePriority();
+
+    public:
+        explicit InterruptController(Scheduler& kernelScheduler);
+        ~InterruptController();
+
+        InterruptController(const InterruptController&) = delete;
+        InterruptController& operator = (const InterruptController&) = delete;
+
+        //starts the ISR thread, raises before this are queued and dispatched once it runs
+        bool initialise();
+        //joins the ISR thread, queued events are discarded and later raises dropped
+        void stop();
+
+        //returns the IRQ number or -1 when every line is taken
+        int allocateIrq(const string& name);
+        //removes the handlers and discards anything queued on the line
+        void freeIrq(int irq);
+        //adds a handler to the line (lines may be shared), returns its id or -1
+        int requestIrq(int irq, TopHalf topHalf, BottomHalf bottomHalf = nullptr);
+        bool releaseIrq(int irq, int actionId);
+        //-1 if no allocated line has that name
+        int findIrq(const string& name) const;
+
+        bool setModeration(int irq, const IrqModeration& moderation);
+        IrqModeration getModeration(int irq) const;
+
+        //never blocks, safe from any thread; false if the line is unallocated or its queue is full
+        bool raise(int irq, uint32_t data = 0);
+
+        //C entry point handed to drivers together with getDriverContext(irq)
+        static void driverRaise(void* context, uint32_t data);
+        void* getDriverContext(int irq);
+
+        IrqStats getStatistics(int irq) const;
+        vector<IrqStats> getAllStatistics() const;
+        void displayStatistics() const;
+};
@@ -0,0 +1,26 @@
+#include "IoEventCounter.h"
+
+using namespace std;
+
+void IoEventCounter::signal(uint64_t amount){
+    {
+        lock_guard<mutex> lock(counterMutex);
+        count += amount;
+    }
+    counterCondition.notify_all();
+}
+
+uint64_t IoEventCounter::read(chrono::microseconds timeout){
+    unique_lock<mutex> lock(counterMutex);
+    counterCondition.wait_for(lock, timeout, [this]{ return count > 0; });
+    uint64_t value = count;
+    count = 0;
+    return value;
+}
+
+uint64_t IoEventCounter::tryRead(){
+    lock_guard<mutex> lock(counterMutex);
+    uint64_t value = count;
+    count = 0;
+    return value;
+}
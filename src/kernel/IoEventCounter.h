@@ -0,0 +1,21 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+using namespace std;
+
+//eventfd-style counter, signal() adds, read() returns the count and resets it
+class IoEventCounter{
+    private:
+        mutable mutex counterMutex;
+        condition_variable counterCondition;
+        uint64_t count = 0;
+
+    public:
+        void signal(uint64_t amount = 1);
+        //0 if nothing was signalled before the timeout
+        uint64_t read(chrono::microseconds timeout);
+        uint64_t tryRead();
+};
@@ -2,6 +2,7 @@
 #include "DeviceRegistry.h"
 #include "Clock.h"
 #include "Logger.h"
+#include "InterruptController.h"
 #include <atomic>
 #include <cstdint>
 #include<iostream>
@@ -19,6 +20,7 @@ Kernel::Kernel() : initialized(false){
     systemClock = make_unique<Clock>();
     logger = make_unique<Logger>();
     scheduler = make_unique<Scheduler>();
+    interrupts = make_unique<InterruptController>(*scheduler);
     dllLoader = make_unique<DllLoader>(*logger);
     vfs = make_unique<VirtualFileSystem>(*logger);
 }
@@ -59,6 +61,12 @@ bool Kernel::initialize() {
         return false;
     }
     logger->log(MessageType::BOOT, "System clock initialized");
+
+    if (!interrupts->initialise()) {
+        logger->log(MessageType::ERRORS, "Failed to initialize interrupt controller");
+        return false;
+    }
+    logger->log(MessageType::BOOT, "Interrupt controller initialized");
     
     if (!vfs->initialize()) {
     logger->log(MessageType::ERRORS, "Failed to initialize VFS");
@@ -74,8 +82,15 @@ bool Kernel::initialize() {
 void Kernel::shutdown() {
     if (!initialized) return;
     
+    logger->log(MessageType::SHUTDOWN, "Stopping interrupt controller...");
+    interrupts->stop();
+
     logger->log(MessageType::SHUTDOWN, "Stopping system ticks...");
     systemClock->stop();
+
+    logger->log(MessageType::SHUTDOWN, "Stopping scheduler workers...");
+    scheduler->disableParallelExecution();
+    scheduler->stopBottomHalves();
     
     logger->log(MessageType::SHUTDOWN, "cleaning up devices...");
     deviceRegistry->cleanup();
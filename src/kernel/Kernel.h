@@ -12,6 +12,7 @@ class Clock;
 class Logger;
 class Scheduler;
 class VirtualFileSystem;
+class InterruptController;
 class Kernel{
     private:
         static unique_ptr<Kernel> instance;
@@ -21,6 +22,8 @@ class Kernel{
         unique_ptr<Clock> systemClock;
         unique_ptr<Logger> logger;
         unique_ptr<Scheduler> scheduler;
+        //ahead of dllLoader so drivers can still release their lines when it unloads them
+        unique_ptr<InterruptController> interrupts;
         unique_ptr<DllLoader> dllLoader;
         unique_ptr<VirtualFileSystem> vfs;
 
@@ -48,8 +51,8 @@ class Kernel{
         bool isInitialized(){return initialized;}
 
         static uint64_t getTicks() {return kernelTickCounter;}
-        static void incrementTicks(){
-            kernelTickCounter.fetch_add(1);
+        static void incrementTicks(uint64_t count = 1){
+            kernelTickCounter.fetch_add(count);
         }
 
         DeviceRegistry& getDeviceRegistry() const {
@@ -64,6 +67,9 @@ class Kernel{
         Scheduler& getScheduler() const{
             return *scheduler;
         }
+        InterruptController& getInterrupts() const{
+            return *interrupts;
+        }
         DllLoader& getDllLoader() const{
             return *dllLoader;
         }
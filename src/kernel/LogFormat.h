@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+//compile-time filter: VOS_LOG / VOS_LOGF call sites below VOS_LOG_MIN_LEVEL compile to nothing
+//set from CMake (-DVOS_LOG_MIN_LEVEL=INFO), defaults to keeping everything
+#define VOS_LOG_LEVEL_TRACE 0
+#define VOS_LOG_LEVEL_DEBUG 1
+#define VOS_LOG_LEVEL_INFO 2
+#define VOS_LOG_LEVEL_ERROR 3
+
+#ifndef VOS_LOG_MIN_LEVEL
+#define VOS_LOG_MIN_LEVEL VOS_LOG_LEVEL_TRACE
+#endif
+
+enum class MessageType{
+    BOOT,
+    INFO,
+    ERRORS,
+    SHUTDOWN,
+    HEARTBEAT,
+    PROMPT,
+    STATUS,
+    HEADER,
+    USER_FEEDBACK,
+    SCHEDULER,
+    TIMER,
+    UART,
+    DLL_LOADER,
+    INIT,
+    VFS,
+};
+
+//per-tick tracing is TRACE, subsystem chatter DEBUG, user facing output INFO
+constexpr int logLevelOf(MessageType type){
+    switch (type) {
+        case MessageType::HEARTBEAT:
+        case MessageType::TIMER:
+        case MessageType::SCHEDULER:
+            return VOS_LOG_LEVEL_TRACE;
+        case MessageType::UART:
+        case MessageType::DLL_LOADER:
+        case MessageType::INIT:
+        case MessageType::VFS:
+            return VOS_LOG_LEVEL_DEBUG;
+        case MessageType::ERRORS:
+            return VOS_LOG_LEVEL_ERROR;
+        default:
+            return VOS_LOG_LEVEL_INFO;
+    }
+}
+
+constexpr bool isLogCompiledIn(MessageType type){
+    return logLevelOf(type) >= VOS_LOG_MIN_LEVEL;
+}
+
+//text form of a log line, shared by Logger and the offline binary log decoder
+inline string formatLogMessage(MessageType type, const string& message, uint64_t tick){
+    switch (type) {
+        case MessageType::BOOT: return "[BOOT] " + message;
+        case MessageType::INFO: return "[INFO] " + message;
+        case MessageType::ERRORS: return "[ERROR] " + message;
+        case MessageType::SHUTDOWN: return "[SHUTDOWN] " + message;
+        case MessageType::HEARTBEAT: return "[TICK " + to_string(tick) + "] " + message;
+        case MessageType::STATUS: return  message;
+        case MessageType::HEADER: return "\n=== " + message + " ===";
+        case MessageType::USER_FEEDBACK: return message;
+        case MessageType::PROMPT: return "";
+        case MessageType::SCHEDULER: return "[SCHEDULER] "+message;
+        case MessageType::TIMER: return "[TIMER] "+message;
+        case MessageType::UART: return "[UART] "+message;
+        case MessageType::DLL_LOADER: return "[DLL_LOADER] "+message;
+        case MessageType::INIT: return "[INIT] "+message;
+        case MessageType::VFS: return "[VFS] "+message;
+        default: return message;
+    }
+}
@@ -0,0 +1,27 @@
+#include "LogRateLimiter.h"
+#include <chrono>
+
+using namespace std;
+
+LogRateLimiter::LogRateLimiter(uint32_t burst, uint32_t messagesPerSecond) :
+        emissionIntervalNanoseconds(1000000000LL / (messagesPerSecond > 0 ? messagesPerSecond : 1)),
+        burstToleranceNanoseconds(emissionIntervalNanoseconds * ((burst > 0 ? burst : 1) - 1)),
+        theoreticalArrival(0),
+        suppressedCount(0){}
+
+bool LogRateLimiter::tryAcquire(uint64_t& suppressedBefore){
+    int64_t now = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t arrival = theoreticalArrival.load(memory_order_relaxed);
+    for (;;) {
+        int64_t start = arrival > now ? arrival : now;
+        if (start - now > burstToleranceNanoseconds) {
+            suppressedCount.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        if (theoreticalArrival.compare_exchange_weak(arrival, start + emissionIntervalNanoseconds, memory_order_relaxed)) {
+            break;
+        }
+    }
+    suppressedBefore = suppressedCount.exchange(0, memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+//token bucket for one log call site, kept as a single "theoretical arrival time" (GCRA)
+//so checking it is one load and one CAS: up to burst messages pass at once,
+//then one per 1/messagesPerSecond. rejected calls are only counted
+class LogRateLimiter{
+    private:
+        const int64_t emissionIntervalNanoseconds;
+        const int64_t burstToleranceNanoseconds;
+        atomic<int64_t> theoreticalArrival;
+        atomic<uint64_t> suppressedCount;
+
+    public:
+        static constexpr uint32_t DEFAULT_BURST = 5;
+        static constexpr uint32_t DEFAULT_MESSAGES_PER_SECOND = 1;
+
+        LogRateLimiter(uint32_t burst = DEFAULT_BURST, uint32_t messagesPerSecond = DEFAULT_MESSAGES_PER_SECOND);
+
+        //true if the message may be logged; suppressedBefore receives the number of
+        //messages dropped since the last one that got through
+        bool tryAcquire(uint64_t& suppressedBefore);
+        uint64_t getSuppressedCount() const {return suppressedCount;}
+};
@@ -3,10 +3,13 @@
 #include<iostream>
 #include <mutex>
 #include <string>
+#include <cstring>
 
 using namespace std;
 // stopping = true - its not initialised
-Logger::Logger():initialized(false), stopping(false){}
+Logger::Logger():initialized(false), stopping(false), enabledTypes(0xFFFFFFFFu), asyncMode(false),
+                 overflowPolicy(LogOverflowPolicy::DROP), activeProducers(0), writerRunning(false), droppedMessages(0), binaryMode(false),
+                 formatCount(0){}
 Logger::~Logger(){
     stop();
 }
@@ -22,9 +25,13 @@ bool Logger::initialize(){
 }
 
 void Logger::stop(){
-    lock_guard<mutex> lock(logMutex);
-    stopping = true;
-    initialized = false;
+    {
+        lock_guard<mutex> lock(logMutex);
+        stopping = true;
+        initialized = false;
+    }
+    stopAsyncWriter();
+    disableBinaryLog();
 }
 
 bool Logger::isInitialized() {
@@ -32,12 +39,73 @@ bool Logger::isInitialized() {
     return initialized && !stopping;
 }
 
+bool Logger::enableAsync(LogOverflowPolicy policy){
+    lock_guard<mutex> lock(logMutex);
+    overflowPolicy = policy;
+    if (asyncMode) {
+        return true;
+    }
+    if (!asyncRing) {
+        asyncRing = make_unique<LogRing>();
+    }
+    writerRunning = true;
+    writerThread = thread(&Logger::writerLoop, this);
+    asyncMode = true;
+    return true;
+}
+
+void Logger::disableAsync(){
+    stopAsyncWriter();
+}
+
+//waits out producers that already chose the async path, then lets the writer drain the ring and exit
+void Logger::stopAsyncWriter(){
+    if (!asyncMode.exchange(false)) {
+        return;
+    }
+    while (activeProducers.load() > 0) {
+        this_thread::yield();
+    }
+    {
+        lock_guard<mutex> lock(writerMutex);
+        writerRunning = false;
+    }
+    writerCondition.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+}
+
+void Logger::setMessageTypeEnabled(MessageType type, bool enable){
+    uint32_t bit = 1u << static_cast<unsigned>(type);
+    if (enable) {
+        enabledTypes.fetch_or(bit);
+    }
+    else{
+        enabledTypes.fetch_and(~bit);
+    }
+}
+
 void Logger::log(MessageType type, const string& message){
+    if (!isEnabled(type)) {
+        return;
+    }
+    activeProducers.fetch_add(1);
+    if (asyncMode.load() && initialized.load() && !stopping.load()) {
+        enqueueRecord(type, message);
+        activeProducers.fetch_sub(1);
+        return;
+    }
+    activeProducers.fetch_sub(1);
+    writeSynchronously(type, message);
+}
+
+void Logger::writeSynchronously(MessageType type, const string& message){
     lock_guard<mutex> lock(logMutex);
     if(!initialized || stopping){
         return;
     }
-    string formattedMessage = formatMessage(type,message);
+    string formattedMessage = formatMessage(type,message,Kernel::getTicks());
     cout<<formattedMessage<<endl;
     if (type == MessageType::PROMPT) {
         cout<<"> "<<flush;
@@ -47,23 +115,189 @@ void Logger::log(MessageType type, const string& message){
     }
 }
 
-string Logger::formatMessage(MessageType type, const string& message) const {
-    switch (type) {
-        case MessageType::BOOT: return "[BOOT] " + message;
-        case MessageType::INFO: return "[INFO] " + message;
-        case MessageType::ERRORS: return "[ERROR] " + message;
-        case MessageType::SHUTDOWN: return "[SHUTDOWN] " + message;
-        case MessageType::HEARTBEAT: return "[TICK " + to_string(Kernel::getTicks()) + "] " + message;
-        case MessageType::STATUS: return  message;
-        case MessageType::HEADER: return "\n=== " + message + " ===";
-        case MessageType::USER_FEEDBACK: return message;
-        case MessageType::PROMPT: return "";
-        case MessageType::SCHEDULER: return "[SCHEDULER] "+message;
-        case MessageType::TIMER: return "[TIMER] "+message;
-        case MessageType::UART: return "[UART] "+message;
-        case MessageType::DLL_LOADER: return "[DLL_LOADER] "+message;
-        case MessageType::INIT: return "[INIT] "+message;
-        case MessageType::VFS: return "[VFS] "+message;
-        default: return message;
-    }
-}
\ No newline at end of file
+void Logger::enqueueRecord(MessageType type, const string& message){
+    LogRecord record;
+    record.type = type;
+    record.tick = Kernel::getTicks();
+    record.truncated = message.size() > LogRecord::MAX_TEXT;
+    record.length = static_cast<uint16_t>(record.truncated ? LogRecord::MAX_TEXT : message.size());
+    memcpy(record.text, message.data(), record.length);
+
+    if (asyncRing->push(record)) {
+        return;
+    }
+    if (overflowPolicy.load() == LogOverflowPolicy::DROP) {
+        droppedMessages.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    while (!asyncRing->push(record)) {
+        writerCondition.notify_one();
+        this_thread::yield();
+    }
+}
+
+size_t Logger::drainRing(string& batch, uint64_t& reportedDrops){
+    LogRecord record;
+    size_t written = 0;
+    while (written < WRITE_BATCH && asyncRing->pop(record)) {
+        string message(record.text, record.length);
+        if (record.truncated) {
+            message += "...";
+        }
+        batch += formatMessage(record.type, message, record.tick);
+        batch += '\n';
+        if (record.type == MessageType::PROMPT) {
+            batch += "> ";
+        }
+        written++;
+    }
+
+    uint64_t dropped = droppedMessages.load(memory_order_relaxed);
+    if (dropped != reportedDrops) {
+        batch += formatMessage(MessageType::ERRORS, to_string(dropped - reportedDrops) + " log messages dropped (ring full)", 0);
+        batch += '\n';
+        reportedDrops = dropped;
+    }
+    return written;
+}
+
+void Logger::writerLoop(){
+    string batch;
+    uint64_t reportedDrops = droppedMessages.load();
+
+    for (;;) {
+        batch.clear();
+        size_t written = drainRing(batch, reportedDrops);
+        if (!batch.empty()) {
+            cout.write(batch.data(), static_cast<streamsize>(batch.size()));
+            cout.flush();
+        }
+        if (written == WRITE_BATCH) {
+            continue;
+        }
+
+        unique_lock<mutex> lock(writerMutex);
+        if (!writerRunning) {
+            break;
+        }
+        writerCondition.wait_for(lock, chrono::milliseconds(2));
+    }
+
+    //writerRunning is only cleared once no producer can still be pushing
+    for (;;) {
+        batch.clear();
+        drainRing(batch, reportedDrops);
+        if (batch.empty()) {
+            break;
+        }
+        cout.write(batch.data(), static_cast<streamsize>(batch.size()));
+    }
+    cout.flush();
+}
+
+uint16_t Logger::registerFormat(MessageType type, const char* format){
+    lock_guard<mutex> lock(logMutex);
+    size_t next = formatCount.load(memory_order_relaxed);
+    if (next == MAX_FORMATS) {
+        return static_cast<uint16_t>(MAX_FORMATS);
+    }
+    registeredFormats[next].type = type;
+    registeredFormats[next].format = format;
+    formatCount.store(next + 1, memory_order_release);
+    uint16_t formatId = static_cast<uint16_t>(next);
+    if (binaryMode) {
+        appendFormatDefinition(formatId);
+    }
+    return formatId;
+}
+
+//caller holds logMutex
+void Logger::appendFormatDefinition(uint16_t formatId){
+    const RegisteredFormat& definition = registeredFormats[formatId];
+    unsigned char entry[BinaryLog::MAX_ENTRY_SIZE];
+    size_t length = strlen(definition.format);
+    if (length > BinaryLog::MAX_ENTRY_SIZE - sizeof(BinaryLog::EntryHeader)) {
+        length = BinaryLog::MAX_ENTRY_SIZE - sizeof(BinaryLog::EntryHeader);
+    }
+    BinaryLog::EntryHeader entryHeader;
+    entryHeader.size = static_cast<uint16_t>(sizeof(entryHeader) + length);
+    entryHeader.kind = BinaryLog::EntryKind::FORMAT_DEFINITION;
+    entryHeader.messageType = static_cast<uint8_t>(definition.type);
+    entryHeader.formatId = formatId;
+    entryHeader.argCount = 0;
+    entryHeader.tick = Kernel::getTicks();
+    memcpy(entry, &entryHeader, sizeof(entryHeader));
+    memcpy(entry + sizeof(entryHeader), definition.format, length);
+    binaryLog->append(entry, entryHeader.size);
+}
+
+void Logger::appendEvent(MessageType type, uint16_t formatId, unsigned char* entry, size_t size, uint16_t argumentCount){
+    BinaryLog::EntryHeader entryHeader;
+    entryHeader.size = static_cast<uint16_t>(size);
+    entryHeader.kind = BinaryLog::EntryKind::EVENT;
+    entryHeader.messageType = static_cast<uint8_t>(type);
+    entryHeader.formatId = formatId;
+    entryHeader.argCount = argumentCount;
+    entryHeader.tick = Kernel::getTicks();
+    memcpy(entry, &entryHeader, sizeof(entryHeader));
+    binaryLog->append(entry, size);
+}
+
+bool Logger::encodeBytes(unsigned char* entry, size_t& size, BinaryLog::ArgumentType type, const void* bytes, size_t length){
+    bool isString = type == BinaryLog::ArgumentType::STR;
+    if (isString && length > BinaryLog::MAX_STRING_ARGUMENT) {
+        length = BinaryLog::MAX_STRING_ARGUMENT;
+    }
+    size_t needed = 1 + (isString ? 1 : 0) + length;
+    if (size + needed > BinaryLog::MAX_ENTRY_SIZE) {
+        return false;
+    }
+    entry[size++] = static_cast<unsigned char>(type);
+    if (isString) {
+        entry[size++] = static_cast<unsigned char>(length);
+    }
+    memcpy(entry + size, bytes, length);
+    size += length;
+    return true;
+}
+
+//lock-free, logf has already checked formatId against formatCount
+string Logger::renderFormat(uint16_t formatId, const string* arguments, size_t argumentCount){
+    const char* format = registeredFormats[formatId].format;
+    return BinaryLog::substituteArguments(format, strlen(format), arguments, argumentCount);
+}
+
+bool Logger::enableBinaryLog(const string& path, size_t capacityBytes){
+    lock_guard<mutex> lock(logMutex);
+    if (binaryMode) {
+        return false;
+    }
+    auto file = make_unique<BinaryLogFile>();
+    if (!file->open(path, capacityBytes)) {
+        return false;
+    }
+    binaryLog = std::move(file);
+    //formats registered before the file existed still need their definitions
+    size_t registered = formatCount.load(memory_order_relaxed);
+    for (size_t formatId = 0; formatId < registered; formatId++) {
+        appendFormatDefinition(static_cast<uint16_t>(formatId));
+    }
+    binaryMode = true;
+    return true;
+}
+
+void Logger::disableBinaryLog(){
+    if (!binaryMode.exchange(false)) {
+        return;
+    }
+    while (activeProducers.load() > 0) {
+        this_thread::yield();
+    }
+    lock_guard<mutex> lock(logMutex);
+    binaryLog->close();
+    binaryLog.reset();
+}
+
+string Logger::formatMessage(MessageType type, const string& message, uint64_t tick) const {
+    return formatLogMessage(type, message, tick);
+}
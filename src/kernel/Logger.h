@@ -1,41 +1,228 @@
 #pragma once
 #include "mutex"
 #include "atomic"
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include<string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "MpmcRing.h"
+#include "LogFormat.h"
+#include "BinaryLogFile.h"
+#include "LogRateLimiter.h"
 
 using namespace std;
-enum class MessageType{
-    BOOT,
-    INFO,
-    ERRORS,
-    SHUTDOWN,
-    HEARTBEAT,
-    PROMPT,
-    STATUS,
-    HEADER,
-    USER_FEEDBACK,
-    SCHEDULER,
-    TIMER,
-    UART,
-    DLL_LOADER,
-    INIT,
-    VFS,
+
+//what an async log call does when the ring is full
+//DROP  - discard the message and count it, the writer reports the count later
+//BLOCK - wait for the writer to free a slot
+enum class LogOverflowPolicy{
+    DROP,
+    BLOCK
+};
+
+//fixed-size record copied into the ring, longer messages are truncated
+struct LogRecord{
+    static constexpr size_t MAX_TEXT = 232;
+
+    MessageType type;
+    bool truncated;
+    uint16_t length;
+    uint64_t tick;
+    char text[MAX_TEXT];
 };
+
 class Logger{
     private:
+        static constexpr size_t ASYNC_CAPACITY = 4096;
+        static constexpr size_t WRITE_BATCH = 256;
+        using LogRing = MpmcRing<LogRecord, ASYNC_CAPACITY>;
+
         atomic<bool> initialized;
         atomic<bool> stopping;
         mutex logMutex;
+        //bit n set = MessageType n is written
+        atomic<uint32_t> enabledTypes;
 
-        string formatMessage(MessageType type, const string& message) const;
+        //async mode: producers only touch the ring, writerThread formats and writes batches
+        atomic<bool> asyncMode;
+        atomic<LogOverflowPolicy> overflowPolicy;
+        atomic<int> activeProducers;
+        atomic<bool> writerRunning;
+        atomic<uint64_t> droppedMessages;
+        unique_ptr<LogRing> asyncRing;
+        thread writerThread;
+        mutex writerMutex;
+        condition_variable writerCondition;
+
+        //binary mode: logf appends the raw arguments to binaryLog, nothing is formatted
+        atomic<bool> binaryMode;
+        unique_ptr<BinaryLogFile> binaryLog;
+        //format id -> (type, format string); registerFormat fills a slot under logMutex and publishes it
+        //through formatCount before returning the id, so logf reads formats without taking a lock
+        static constexpr size_t MAX_FORMATS = 1024;
+        struct RegisteredFormat {
+            MessageType type;
+            const char* format;
+        };
+        RegisteredFormat registeredFormats[MAX_FORMATS];
+        atomic<size_t> formatCount;
+
+        string formatMessage(MessageType type, const string& message, uint64_t tick) const;
+        void writeSynchronously(MessageType type, const string& message);
+        void enqueueRecord(MessageType type, const string& message);
+        void writerLoop();
+        size_t drainRing(string& batch, uint64_t& reportedDrops);
+        void stopAsyncWriter();
+        void appendFormatDefinition(uint16_t formatId);
+        //entry holds the encoded arguments after room for the header, appendEvent fills the header in
+        void appendEvent(MessageType type, uint16_t formatId, unsigned char* entry, size_t size, uint16_t argumentCount);
+        string renderFormat(uint16_t formatId, const string* arguments, size_t argumentCount);
+
+        static bool encodeBytes(unsigned char* entry, size_t& size, BinaryLog::ArgumentType type, const void* bytes, size_t length);
+        template<typename T>
+        static bool encodeArgument(unsigned char* entry, size_t& size, const T& value);
+        template<typename T>
+        static string argumentToString(const T& value);
         
     public:
         Logger();
         ~Logger();
 
         bool initialize();
+        //flushes everything logged before the call when running asynchronously
         void stop();
         bool isInitialized();
 
+        bool enableAsync(LogOverflowPolicy policy = LogOverflowPolicy::DROP);
+        void disableAsync();
+        bool isAsync() const {return asyncMode;}
+        void setOverflowPolicy(LogOverflowPolicy policy) {overflowPolicy = policy;}
+        uint64_t getDroppedMessageCount() const {return droppedMessages;}
+
         void log(MessageType type,const string& message);
-};
\ No newline at end of file
+
+        bool isEnabled(MessageType type) const {
+            return (enabledTypes.load(memory_order_relaxed) >> static_cast<unsigned>(type)) & 1u;
+        }
+        void setMessageTypeEnabled(MessageType type, bool enable);
+        void setEnabledMask(uint32_t mask) {enabledTypes = mask;}
+        uint32_t getEnabledMask() const {return enabledTypes;}
+
+        //emitted by VOS_LOG_RATE_LIMITED once a throttled call site gets through again
+        void logSuppressed(MessageType type, uint64_t suppressedCount){
+            log(type, "last message repeated " + to_string(suppressedCount) + " times");
+        }
+
+        //build only runs when the type is enabled
+        template<typename MessageBuilder>
+        void logLazy(MessageType type, MessageBuilder build){
+            if (isEnabled(type)) {
+                log(type, build());
+            }
+        }
+
+        //call sites register a format once ("{}" per argument) and then pass raw values,
+        //in binary mode the values go to the mapped file as is, otherwise they are formatted here
+        //the format is kept by pointer and must outlive the logger, VOS_LOGF passes string literals
+        uint16_t registerFormat(MessageType type, const char* format);
+        template<typename... Args>
+        void logf(MessageType type, uint16_t formatId, const Args&... arguments);
+
+        bool enableBinaryLog(const string& path, size_t capacityBytes = 16 * 1024 * 1024);
+        void disableBinaryLog();
+        bool isBinaryLogEnabled() const {return binaryMode;}
+};
+
+//the message expression is only evaluated when the type is compiled in and enabled
+#define VOS_LOG(logger, type, message) \
+    do { \
+        if (isLogCompiledIn(type) && (logger).isEnabled(type)) { \
+            (logger).log((type), (message)); \
+        } \
+    } while (0)
+
+//per call site token bucket, throttled messages are counted but never built,
+//the count is reported as "last message repeated N times" before the next one that passes
+#define VOS_LOG_RATE_LIMITED(logger, type, message) \
+    do { \
+        if (isLogCompiledIn(type) && (logger).isEnabled(type)) { \
+            static LogRateLimiter vosLogLimiter; \
+            uint64_t vosLogSuppressed = 0; \
+            if (vosLogLimiter.tryAcquire(vosLogSuppressed)) { \
+                if (vosLogSuppressed > 0) { \
+                    (logger).logSuppressed((type), vosLogSuppressed); \
+                } \
+                (logger).log((type), (message)); \
+            } \
+        } \
+    } while (0)
+
+//registers the format on first use of this call site, then logs through logf
+#define VOS_LOGF(logger, type, format, ...) \
+    do { \
+        if (isLogCompiledIn(type) && (logger).isEnabled(type)) { \
+            static const uint16_t vosLogFormatId = (logger).registerFormat((type), (format)); \
+            (logger).logf((type), vosLogFormatId, __VA_ARGS__); \
+        } \
+    } while (0)
+
+template<typename T>
+bool Logger::encodeArgument(unsigned char* entry, size_t& size, const T& value){
+    if constexpr (is_floating_point<T>::value) {
+        double number = static_cast<double>(value);
+        return encodeBytes(entry, size, BinaryLog::ArgumentType::F64, &number, sizeof(number));
+    }
+    else if constexpr (is_integral<T>::value && is_signed<T>::value) {
+        int64_t number = static_cast<int64_t>(value);
+        return encodeBytes(entry, size, BinaryLog::ArgumentType::I64, &number, sizeof(number));
+    }
+    else if constexpr (is_integral<T>::value) {
+        uint64_t number = static_cast<uint64_t>(value);
+        return encodeBytes(entry, size, BinaryLog::ArgumentType::U64, &number, sizeof(number));
+    }
+    else if constexpr (is_convertible<const T&, const char*>::value) {
+        const char* text = value;
+        return encodeBytes(entry, size, BinaryLog::ArgumentType::STR, text, strlen(text));
+    }
+    else{
+        return encodeBytes(entry, size, BinaryLog::ArgumentType::STR, value.data(), value.size());
+    }
+}
+
+template<typename T>
+string Logger::argumentToString(const T& value){
+    if constexpr (is_arithmetic<T>::value) {
+        return to_string(value);
+    }
+    else{
+        return string(value);
+    }
+}
+
+template<typename... Args>
+void Logger::logf(MessageType type, uint16_t formatId, const Args&... arguments){
+    //ids past the table (registerFormat ran out of slots) were never published
+    if (!isEnabled(type) || formatId >= formatCount.load(memory_order_acquire)) {
+        return;
+    }
+    activeProducers.fetch_add(1);
+    if (binaryMode.load() && initialized.load() && !stopping.load()) {
+        unsigned char entry[BinaryLog::MAX_ENTRY_SIZE];
+        size_t size = sizeof(BinaryLog::EntryHeader);
+        bool fits = (true && ... && encodeArgument(entry, size, arguments));
+        if (fits) {
+            appendEvent(type, formatId, entry, size, static_cast<uint16_t>(sizeof...(Args)));
+        }
+        activeProducers.fetch_sub(1);
+        return;
+    }
+    activeProducers.fetch_sub(1);
+
+    string rendered[sizeof...(Args) + 1] = {argumentToString(arguments)..., string()};
+    log(type, renderFormat(formatId, rendered, sizeof...(Args)));
+}
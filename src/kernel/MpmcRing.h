@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+//bounded multi-producer/multi-consumer ring (Vyukov), Capacity must be a power of two
+//each cell carries a sequence number, so producers and consumers only contend on
+//their own position counter and never block each other
+template<typename T, size_t Capacity>
+class MpmcRing{
+    static_assert((Capacity & (Capacity - 1)) == 0, "MpmcRing capacity must be a power of two");
+
+    private:
+        struct Cell{
+            atomic<size_t> sequence;
+            T value;
+        };
+
+        Cell cells[Capacity];
+        alignas(64) atomic<size_t> enqueuePosition;
+        alignas(64) atomic<size_t> dequeuePosition;
+
+    public:
+        MpmcRing() : enqueuePosition(0), dequeuePosition(0){
+            for (size_t index = 0; index < Capacity; index++) {
+                cells[index].sequence.store(index, memory_order_relaxed);
+            }
+        }
+
+        MpmcRing(const MpmcRing&) = delete;
+        MpmcRing& operator = (const MpmcRing&) = delete;
+
+        //returns false when the ring is full
+        bool push(const T& value){
+            Cell* cell;
+            size_t position = enqueuePosition.load(memory_order_relaxed);
+            for (;;) {
+                cell = &cells[position & (Capacity - 1)];
+                size_t sequence = cell->sequence.load(memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0) {
+                    if (enqueuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else{
+                    position = enqueuePosition.load(memory_order_relaxed);
+                }
+            }
+            cell->value = value;
+            cell->sequence.store(position + 1, memory_order_release);
+            return true;
+        }
+
+        //returns false when the ring is empty
+        bool pop(T& value){
+            Cell* cell;
+            size_t position = dequeuePosition.load(memory_order_relaxed);
+            for (;;) {
+                cell = &cells[position & (Capacity - 1)];
+                size_t sequence = cell->sequence.load(memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+                if (difference == 0) {
+                    if (dequeuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else{
+                    position = dequeuePosition.load(memory_order_relaxed);
+                }
+            }
+            value = cell->value;
+            cell->sequence.store(position + Capacity, memory_order_release);
+            return true;
+        }
+
+        bool empty() const {
+            return enqueuePosition.load(memory_order_acquire) == dequeuePosition.load(memory_order_acquire);
+        }
+};
@@ -0,0 +1,134 @@
+#include "VfsPoll.h"
+#include "VirtualFileSystem.h"
+#include <algorithm>
+
+using namespace std;
+
+VfsPollSet::VfsPollSet(VirtualFileSystem& fileSystem) : vfs(fileSystem) {}
+
+VfsPollSet::~VfsPollSet(){
+    unordered_map<int, Interest> remaining;
+    {
+        lock_guard<mutex> lock(pollMutex);
+        remaining.swap(interests);
+    }
+    for (auto& pair : remaining) {
+        detach(pair.first, pair.second.readiness);
+    }
+}
+
+void VfsPollSet::detach(int fd, const shared_ptr<DeviceReadiness>& readiness){
+    lock_guard<mutex> watchLock(readiness->watchMutex);
+    auto& watchers = readiness->watchers;
+    watchers.erase(std::remove(watchers.begin(), watchers.end(), make_pair(this, fd)), watchers.end());
+}
+
+int VfsPollSet::add(int fd, uint32_t events, uint64_t userData){
+    shared_ptr<DeviceReadiness> readiness = vfs.readinessFor(fd);
+    if (!readiness) {
+        return VirtualFileSystem::VFS_ERROR_BAD_FD;
+    }
+    {
+        lock_guard<mutex> lock(pollMutex);
+        if (interests.count(fd)) {
+            return VirtualFileSystem::VFS_ERROR_ALREADY_OPEN;
+        }
+        interests[fd] = Interest{events, userData, readiness, false};
+    }
+
+    //pollMutex is taken inside watchMutex by markReady, so never the other way round
+    lock_guard<mutex> watchLock(readiness->watchMutex);
+    readiness->watchers.emplace_back(this, fd);
+    if (readiness->events.load(memory_order_acquire) != 0) {
+        markReady(fd);
+    }
+    return VirtualFileSystem::VFS_SUCCESS;
+}
+
+int VfsPollSet::modify(int fd, uint32_t events, uint64_t userData){
+    shared_ptr<DeviceReadiness> readiness;
+    {
+        lock_guard<mutex> lock(pollMutex);
+        auto it = interests.find(fd);
+        if (it == interests.end()) {
+            return VirtualFileSystem::VFS_ERROR_NOT_FOUND;
+        }
+        it->second.events = events;
+        it->second.userData = userData;
+        readiness = it->second.readiness;
+    }
+    //the new mask may already be satisfied
+    lock_guard<mutex> watchLock(readiness->watchMutex);
+    if (readiness->events.load(memory_order_acquire) != 0) {
+        markReady(fd);
+    }
+    return VirtualFileSystem::VFS_SUCCESS;
+}
+
+int VfsPollSet::remove(int fd){
+    shared_ptr<DeviceReadiness> readiness;
+    {
+        lock_guard<mutex> lock(pollMutex);
+        auto it = interests.find(fd);
+        if (it == interests.end()) {
+            return VirtualFileSystem::VFS_ERROR_NOT_FOUND;
+        }
+        readiness = std::move(it->second.readiness);
+        interests.erase(it);
+    }
+    detach(fd, readiness);
+    return VirtualFileSystem::VFS_SUCCESS;
+}
+
+void VfsPollSet::markReady(int fd){
+    {
+        lock_guard<mutex> lock(pollMutex);
+        auto it = interests.find(fd);
+        if (it == interests.end() || it->second.queued) {
+            return;
+        }
+        it->second.queued = true;
+        readyList.push_back(fd);
+    }
+    readyCondition.notify_all();
+}
+
+size_t VfsPollSet::wait(VfsPollEvent* events, size_t maxEvents, chrono::microseconds timeout){
+    bool forever = timeout.count() < 0;
+    auto deadline = chrono::steady_clock::now() + (forever ? chrono::microseconds(0) : timeout);
+    unique_lock<mutex> lock(pollMutex);
+    for (;;) {
+        size_t count = 0;
+        //each queued fd is looked at once per pass; still-ready ones go to the back (level triggered)
+        size_t pending = readyList.size();
+        while (pending-- > 0 && count < maxEvents) {
+            int fd = readyList.front();
+            readyList.pop_front();
+            auto it = interests.find(fd);
+            if (it == interests.end()) {
+                continue;
+            }
+            Interest& interest = it->second;
+            uint32_t mask = interest.events | VirtualFileSystem::VFS_POLLERR | VirtualFileSystem::VFS_POLLHUP;
+            uint32_t ready = interest.readiness->events.load(memory_order_acquire) & mask;
+            if (!ready) {
+                interest.queued = false;
+                continue;
+            }
+            events[count].fd = fd;
+            events[count].events = ready;
+            events[count].userData = interest.userData;
+            count++;
+            readyList.push_back(fd);
+        }
+        if (count > 0) {
+            return count;
+        }
+        if (forever) {
+            readyCondition.wait(lock);
+        }
+        else if (readyCondition.wait_until(lock, deadline) == cv_status::timeout && readyList.empty()) {
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class VirtualFileSystem;
+class VfsPollSet;
+
+//readiness of one device, shared with poll sets and blocked readers so it outlives unregisterDevice
+struct DeviceReadiness {
+    //VFS_POLL* bits, read lock-free by waiters
+    atomic<uint32_t> events{0};
+    //false for devices that never signal, they are treated as always readable and writable
+    bool signalled = false;
+
+    //guards watchers and pairs with changed for single-device waits
+    mutex watchMutex;
+    condition_variable changed;
+    vector<pair<VfsPollSet*, int>> watchers;
+};
+
+//POSIX pollfd equivalent for VirtualFileSystem::poll
+struct VfsPollFd {
+    int fd = -1;
+    uint32_t events = 0;
+    uint32_t revents = 0;
+};
+
+struct VfsPollEvent {
+    int fd;
+    uint32_t events;
+    uint64_t userData;
+};
+
+//epoll-style interest set, level triggered
+//signals push the fd onto a ready list so wait() only looks at devices that changed,
+//not at every registered one; fds are resolved at add() time like epoll does
+class VfsPollSet{
+    private:
+        struct Interest{
+            uint32_t events;
+            uint64_t userData;
+            shared_ptr<DeviceReadiness> readiness;
+            bool queued;
+        };
+
+        VirtualFileSystem& vfs;
+        mutex pollMutex;
+        condition_variable readyCondition;
+        unordered_map<int, Interest> interests;
+        deque<int> readyList;
+
+        void detach(int fd, const shared_ptr<DeviceReadiness>& readiness);
+
+    public:
+        explicit VfsPollSet(VirtualFileSystem& fileSystem);
+        ~VfsPollSet();
+
+        VfsPollSet(const VfsPollSet&) = delete;
+        VfsPollSet& operator = (const VfsPollSet&) = delete;
+
+        //VFS_SUCCESS or a VFS_ERROR_* code
+        int add(int fd, uint32_t events, uint64_t userData = 0);
+        int modify(int fd, uint32_t events, uint64_t userData = 0);
+        int remove(int fd);
+
+        //fills up to maxEvents ready entries, 0 on timeout; a negative timeout waits indefinitely
+        size_t wait(VfsPollEvent* events, size_t maxEvents, chrono::microseconds timeout);
+
+        //called by the VFS with the device's watchMutex held
+        void markReady(int fd);
+};
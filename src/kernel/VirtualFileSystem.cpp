@@ -7,9 +7,12 @@
 #include <cstring>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 #include "HardwareDevice.h"
+#include "AsyncIoEngine.h"
+#include "DmaController.h"
 using namespace std;
 
 VirtualFileSystem::VirtualFileSystem(Logger& log) : logger(log), initialized(false) {
@@ -21,7 +24,7 @@ VirtualFileSystem::~VirtualFileSystem(){
 }
 
 bool VirtualFileSystem::initialize(){
-    lock_guard<mutex> lock(vfsMutex);
+    unique_lock<shared_mutex> lock(namespaceMutex);
     if (initialized) {
         return true;
     }
@@ -33,7 +36,16 @@ bool VirtualFileSystem::initialize(){
 }
 
 void VirtualFileSystem::cleanup() {
-    lock_guard<mutex> lock(vfsMutex);
+    //async workers and the DMA engine need the namespace lock to finish their batches, stop them before taking it
+    {
+        lock_guard<mutex> asyncLock(asyncIoMutex);
+        asyncIo.reset();
+    }
+    {
+        lock_guard<mutex> dmaLock(dmaMutex);
+        dma.reset();
+    }
+    unique_lock<shared_mutex> lock(namespaceMutex);
     
     if (!initialized) {
         return;
@@ -41,11 +53,13 @@ void VirtualFileSystem::cleanup() {
     
     logger.log(MessageType::VFS, "Cleaning up virtual filesystem...");
     for (auto& pair : deviceNodes) {
-        if (pair.second->isOpen) {
+        if (pair.second->isOpen()) {
             logger.log(MessageType::VFS, "Force closing device: " + pair.first);
-            pair.second->isOpen = false;
-            pair.second->openCount = 0;
+            closeDescriptorsFor(pair.second.get());
         }
+        drainNode(*pair.second);
+        pair.second->readiness->events.fetch_or(VFS_POLLHUP);
+        notifyReadiness(*pair.second->readiness);
     }
     
     deviceNodes.clear();
@@ -59,15 +73,21 @@ bool VirtualFileSystem::registerDevice(const std::string& driverName, LoadedDriv
         return false;
     }
 
-    std::string devicePath = generateDevicePath(driverName);
-
-    auto hardwareDevice = std::make_unique<HardwareDevice>(driver, driverName, "Hardware");
-
-    return registerDevice(devicePath, std::move(hardwareDevice));
+    //one node per driver instance, v1 drivers always have exactly one
+    bool allRegistered = true;
+    for (int index = 0; index < driver->instanceCount; index++) {
+        std::string devicePath = generateDevicePath(driverName, index);
+        std::string deviceName = driver->instanceCount > 1 ? driverName + "#" + to_string(index) : driverName;
+        auto hardwareDevice = std::make_unique<HardwareDevice>(driver, deviceName, "Hardware", index);
+        if (!registerDevice(devicePath, std::move(hardwareDevice))) {
+            allRegistered = false;
+        }
+    }
+    return allRegistered;
 }
 
 bool VirtualFileSystem::registerDevice(const std::string& devicePath, std::unique_ptr<Device> device) {
-    lock_guard<mutex> lock(vfsMutex);
+    unique_lock<shared_mutex> lock(namespaceMutex);
     
     if (!device) {
         logger.log(MessageType::VFS, "Cannot register null device: " + devicePath);
@@ -91,56 +111,70 @@ bool VirtualFileSystem::registerDevice(const std::string& devicePath, std::uniqu
     
     string deviceName = device->getName();
     auto deviceNode = make_unique<DeviceNode>(devicePath, deviceName, std::move(device));
+    //devices that signal start writable and wait for their first readable edge
+    bool signalled = deviceNode->device->signalsReadiness();
+    deviceNode->readiness->signalled = signalled;
+    deviceNode->readiness->events.store(signalled ? VFS_POLLOUT : VFS_POLLIN | VFS_POLLOUT);
     deviceNodes[devicePath] = std::move(deviceNode);
     
     logger.log(MessageType::VFS, "Device registered: " + devicePath + " (" + deviceName + ")");
     return true;
 }
 bool VirtualFileSystem::unregisterDevice(const string& devicePath){
-    lock_guard<mutex> lock(vfsMutex);
+    closeDmaChannels(devicePath);
+    unique_lock<shared_mutex> lock(namespaceMutex);
 
     auto it = deviceNodes.find(devicePath);
     if (it==deviceNodes.end()) {
         logger.log(MessageType::VFS, "Device not found for unregister: " + devicePath);
         return false;
     }
-    if (it->second->isOpen) {
+    if (it->second->isOpen()) {
         logger.log(MessageType::VFS, "closing device: " + devicePath);
-        it->second->isOpen = false;
+        closeDescriptorsFor(it->second.get());
     }
 
     string driverName = it->second->deviceName;
+    drainNode(*it->second);
+    it->second->readiness->events.fetch_or(VFS_POLLHUP);
+    notifyReadiness(*it->second->readiness);
     deviceNodes.erase(it);
     logger.log(MessageType::VFS, "Device unregistered: " + devicePath + " (" + driverName + ")");
     return true;
 }
-string VirtualFileSystem::generateDevicePath(const string& driverName){
+string VirtualFileSystem::generateDevicePath(const string& driverName, int instance){
     string path = devRoot + "/";
+    string index = to_string(instance);
     if (driverName.find("UART") != string::npos) {
-        path+="uart0";
+        path += "uart" + index;
     }
     else if (driverName.find("ADC") != string::npos) {
-        path += "adc0";
+        path += "adc" + index;
     }
     else if (driverName.find("GPIO") != string::npos) {
-        path += "gpio0";
+        path += "gpio" + index;
     }
     else if (driverName.find("I2C") != string::npos) {
-        path += "i2c0";
+        path += "i2c" + index;
     }
     else if (driverName.find("SPI") != string::npos) {
-        path += "spi0";
+        path += "spi" + index;
     }
     else if (driverName.find("Timer") != string::npos) {
-        path += "timer0";
+        path += "timer" + index;
     }
     else if (driverName.find("PWM") != string::npos) {
-        path += "pwm0";
+        path += "pwm" + index;
     }
     else{
         string lower = driverName;
         transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-        path+=lower.empty() ? "generic0" : lower;
+        if (lower.empty()) {
+            path += "generic" + index;
+        }
+        else{
+            path += instance > 0 ? lower + index : lower;
+        }
     }
     return path;
 }
@@ -155,13 +189,77 @@ bool VirtualFileSystem::validateDevicePath(const string& devicePath) const {
     return true;
 }
 
+//I/O holds the node lock after dropping the namespace lock, so wait for it before the node is freed
+//callers hold namespaceMutex exclusively, which stops new I/O from finding the node
+void VirtualFileSystem::drainNode(DeviceNode& node){
+    lock_guard<mutex> ioLock(node.ioMutex);
+}
+
 void VirtualFileSystem::updateLastAccess(DeviceNode& node){
     node.lastAccess = chrono::steady_clock::now();
 }
 
-int VirtualFileSystem::openDevice(const string& devicePath){
-    lock_guard<mutex> lock(vfsMutex);
+FileDescription* VirtualFileSystem::descriptorFor(int fd){
+    if (fd < 0 || fd >= MAX_OPEN_FILES || !descriptorTable[fd].node) {
+        return nullptr;
+    }
+    return &descriptorTable[fd];
+}
+
+const FileDescription* VirtualFileSystem::descriptorFor(int fd) const {
+    if (fd < 0 || fd >= MAX_OPEN_FILES || !descriptorTable[fd].node) {
+        return nullptr;
+    }
+    return &descriptorTable[fd];
+}
+
+FileDescription* VirtualFileSystem::descriptorFor(const VfsIoRequest& request){
+    FileDescription* description = descriptorFor(request.fd);
+    if (!description || (request.generation && description->generation != request.generation)) {
+        return nullptr;
+    }
+    return description;
+}
+
+const FileDescription* VirtualFileSystem::descriptorFor(const VfsIoRequest& request) const {
+    const FileDescription* description = descriptorFor(request.fd);
+    if (!description || (request.generation && description->generation != request.generation)) {
+        return nullptr;
+    }
+    return description;
+}
+
+//takes dmaMutex rather than the namespace lock, closing a channel closes its descriptor through close()
+int VirtualFileSystem::closeDmaChannels(const string& devicePath){
+    lock_guard<mutex> lock(dmaMutex);
+    return dma ? dma->closeChannelsOn(devicePath) : 0;
+}
+
+void VirtualFileSystem::releaseDescriptor(int fd){
+    FileDescription& description = descriptorTable[fd];
+    description.node->refCount--;
+    description = FileDescription();
+}
+
+int VirtualFileSystem::closeDescriptorsFor(DeviceNode* node){
+    lock_guard<mutex> ioLock(node->ioMutex);
+    int closed = 0;
+    for (int fd = 0; fd < MAX_OPEN_FILES && node->refCount > 0; fd++) {
+        if (descriptorTable[fd].node == node) {
+            releaseDescriptor(fd);
+            closed++;
+        }
+    }
+    return closed;
+}
 
+int VirtualFileSystem::openDevice(const string& devicePath, int flags, uint64_t* generation){
+    unique_lock<shared_mutex> lock(namespaceMutex);
+
+    if ((flags & VFS_O_RDWR) == 0) {
+        logger.log(MessageType::VFS, "Open needs read and/or write access: " + devicePath);
+        return VFS_ERROR_ACCESS;
+    }
     if (!validateDevicePath(devicePath)) {
         logger.log(MessageType::VFS, "Invalid path: " + devicePath);
         return VFS_ERROR_INVALID_PATH;
@@ -174,20 +272,33 @@ int VirtualFileSystem::openDevice(const string& devicePath){
 
     auto& node = it->second;
 
-    if (node->isOpen) {
-        logger.log(MessageType::VFS, "device already open: " + devicePath);
-        return VFS_ERROR_ALREADY_OPEN;
+    //lowest free slot, like POSIX
+    int fd = 0;
+    while (fd < MAX_OPEN_FILES && descriptorTable[fd].node) {
+        fd++;
+    }
+    if (fd == MAX_OPEN_FILES) {
+        logger.log(MessageType::VFS, "descriptor table full, cannot open: " + devicePath);
+        return VFS_ERROR_TOO_MANY_OPEN;
     }
 
-    node->isOpen = true;
+    descriptorTable[fd].node = node.get();
+    descriptorTable[fd].flags = flags;
+    descriptorTable[fd].offset = 0;
+    descriptorTable[fd].generation = nextGeneration++;
+    if (generation) {
+        *generation = descriptorTable[fd].generation;
+    }
+    node->refCount++;
     node->openCount++;
     updateLastAccess(*node);
-    logger.log(MessageType::VFS, "Device opened: "+devicePath);
-    return VFS_SUCCESS;
+    logger.log(MessageType::VFS, "Device opened: " + devicePath + " (fd " + to_string(fd) + ")");
+    return fd;
 }
 
 int VirtualFileSystem::closeDevice(const string& devicePath){
-    lock_guard<mutex> lock(vfsMutex);
+    int closed = closeDmaChannels(devicePath);
+    unique_lock<shared_mutex> lock(namespaceMutex);
 
     auto it = deviceNodes.find(devicePath);
 
@@ -197,63 +308,453 @@ int VirtualFileSystem::closeDevice(const string& devicePath){
     }
 
     auto& node = it->second;
-    if (!node->isOpen) {
+    if (!node->isOpen() && closed == 0) {
         logger.log(MessageType::VFS, "Device not open: " + devicePath);
         return VFS_ERROR_NOT_OPEN;
     }
-    node->isOpen = false;
+    closed += closeDescriptorsFor(node.get());
     updateLastAccess(*node);
-    logger.log(MessageType::VFS, "Device close: " + devicePath);
+    logger.log(MessageType::VFS, "Device close: " + devicePath + " (" + to_string(closed) + " descriptors)");
+    return VFS_SUCCESS;
+}
+
+int VirtualFileSystem::close(int fd, uint64_t generation){
+    unique_lock<shared_mutex> lock(namespaceMutex);
+    FileDescription* description = descriptorFor(fd);
+    if (!description || (generation && description->generation != generation)) {
+        return VFS_ERROR_BAD_FD;
+    }
+    lock_guard<mutex> ioLock(description->node->ioMutex);
+    updateLastAccess(*description->node);
+    releaseDescriptor(fd);
     return VFS_SUCCESS;
 }
 
+int VirtualFileSystem::read(int fd, void* buffer, size_t size){
+    VfsIoRequest request;
+    request.op = VfsIoOp::READ;
+    request.fd = fd;
+    request.buffer = buffer;
+    request.size = size;
+    for (;;) {
+        shared_lock<shared_mutex> lock(namespaceMutex);
+        FileDescription* description = descriptorFor(fd);
+        if (!description) {
+            return VFS_ERROR_BAD_FD;
+        }
+        unique_lock<mutex> ioLock(description->node->ioMutex);
+        lock.unlock();
+        int result = transfer(*description, request);
+        if (result != VFS_ERROR_WOULD_BLOCK || (description->flags & VFS_O_NONBLOCK)) {
+            if (result >= 0) {
+                updateLastAccess(*description->node);
+            }
+            return result;
+        }
+        //sleep without any VFS lock held, then look the fd up again since it may have been closed
+        shared_ptr<DeviceReadiness> readiness = description->node->readiness;
+        ioLock.unlock();
+        if (!(waitForEvents(*readiness, VFS_POLLIN) & VFS_POLLIN)) {
+            return VFS_ERROR_DRIVER_FAIL;
+        }
+    }
+}
+
+int VirtualFileSystem::write(int fd, const void* buffer, size_t size){
+    shared_lock<shared_mutex> lock(namespaceMutex);
+    FileDescription* description = descriptorFor(fd);
+    if (!description) {
+        return VFS_ERROR_BAD_FD;
+    }
+    if (!(description->flags & VFS_O_WRONLY)) {
+        return VFS_ERROR_ACCESS;
+    }
+    unique_lock<mutex> ioLock(description->node->ioMutex);
+    lock.unlock();
+    int result = description->node->device->write(buffer, size);
+    updateLastAccess(*description->node);
+    if (result < 0) {
+        return VFS_ERROR_DRIVER_FAIL;
+    }
+    description->offset += static_cast<uint64_t>(result);
+    return result;
+}
+
+int VirtualFileSystem::ioctl(int fd, int parameter, int value){
+    shared_lock<shared_mutex> lock(namespaceMutex);
+    FileDescription* description = descriptorFor(fd);
+    if (!description) {
+        return VFS_ERROR_BAD_FD;
+    }
+    unique_lock<mutex> ioLock(description->node->ioMutex);
+    lock.unlock();
+    bool result = description->node->device->configure(parameter, value);
+    updateLastAccess(*description->node);
+    return result ? VFS_SUCCESS : VFS_ERROR_DRIVER_FAIL;
+}
+
+int64_t VirtualFileSystem::tell(int fd) const {
+    shared_lock<shared_mutex> lock(namespaceMutex);
+    const FileDescription* description = descriptorFor(fd);
+    if (!description) {
+        return VFS_ERROR_BAD_FD;
+    }
+    unique_lock<mutex> ioLock(description->node->ioMutex);
+    lock.unlock();
+    return static_cast<int64_t>(description->offset);
+}
+
+//caller holds the node's ioMutex
+int VirtualFileSystem::transfer(FileDescription& description, const VfsIoRequest& request){
+    bool reading = request.op == VfsIoOp::READ || request.op == VfsIoOp::READV;
+    if (!(description.flags & (reading ? VFS_O_RDONLY : VFS_O_WRONLY))) {
+        return VFS_ERROR_ACCESS;
+    }
+    //consume the readable edge before reading, data that arrives during the read signals again
+    DeviceReadiness& readiness = *description.node->readiness;
+    if (reading && readiness.signalled && !(readiness.events.fetch_and(~VFS_POLLIN) & VFS_POLLIN)) {
+        return VFS_ERROR_WOULD_BLOCK;
+    }
+    if (reading) {
+        acknowledgeInterrupt(readiness);
+    }
+    Device* device = description.node->device.get();
+    int result = VFS_ERROR_DRIVER_FAIL;
+    switch (request.op) {
+        case VfsIoOp::READ:
+            result = device->read(request.buffer, request.size);
+            break;
+        case VfsIoOp::WRITE:
+            result = device->write(request.buffer, request.size);
+            break;
+        case VfsIoOp::READV:
+            result = device->readv(request.iov, request.iovcnt);
+            break;
+        case VfsIoOp::WRITEV:
+            result = device->writev(request.iov, request.iovcnt);
+            break;
+    }
+    //same rule as read(): a read that moves nothing is a driver failure
+    if (result < 0 || (reading && result == 0)) {
+        return VFS_ERROR_DRIVER_FAIL;
+    }
+    description.offset += static_cast<uint64_t>(result);
+    return result;
+}
+
+int VirtualFileSystem::readv(int fd, const IoVec* iov, int iovcnt){
+    VfsIoRequest request;
+    request.op = VfsIoOp::READV;
+    request.fd = fd;
+    request.iov = iov;
+    request.iovcnt = iovcnt;
+    submitBatch(&request, 1);
+    return request.result;
+}
+
+int VirtualFileSystem::writev(int fd, const IoVec* iov, int iovcnt){
+    VfsIoRequest request;
+    request.op = VfsIoOp::WRITEV;
+    request.fd = fd;
+    request.iov = iov;
+    request.iovcnt = iovcnt;
+    submitBatch(&request, 1);
+    return request.result;
+}
+
+size_t VirtualFileSystem::submitBatch(VfsIoRequest* requests, size_t count){
+    //the namespace lock stays shared for the whole batch so descriptors can't close under it
+    shared_lock<shared_mutex> lock(namespaceMutex);
+    auto now = chrono::steady_clock::now();
+    DeviceNode* heldNode = nullptr;
+    unique_lock<mutex> ioLock;
+    size_t succeeded = 0;
+
+    size_t index = 0;
+    while (index < count) {
+        VfsIoRequest& request = requests[index];
+        FileDescription* description = descriptorFor(request);
+        if (!description) {
+            request.result = VFS_ERROR_BAD_FD;
+            index++;
+            continue;
+        }
+        //only switch device locks when the device changes, one at a time keeps the lock order simple
+        if (description->node != heldNode) {
+            if (heldNode) {
+                heldNode->lastAccess = now;
+            }
+            ioLock = unique_lock<mutex>(description->node->ioMutex);
+            heldNode = description->node;
+        }
+        size_t runLength = batchRunLength(requests + index, count - index, description->node);
+        if (runLength > 1) {
+            succeeded += transferRun(requests + index, runLength);
+            index += runLength;
+            continue;
+        }
+        request.result = transfer(*description, request);
+        if (request.result >= 0) {
+            succeeded++;
+        }
+        index++;
+    }
+    if (heldNode) {
+        heldNode->lastAccess = now;
+    }
+    return succeeded;
+}
+
+//how many requests from the first one are plain reads (or writes) on the same device,
+//those go to the device as one readBatch/writeBatch; signalling devices keep per-request edge handling
+size_t VirtualFileSystem::batchRunLength(const VfsIoRequest* requests, size_t count, DeviceNode* node) const {
+    VfsIoOp op = requests[0].op;
+    if ((op != VfsIoOp::READ && op != VfsIoOp::WRITE) || node->readiness->signalled) {
+        return 1;
+    }
+    size_t length = 1;
+    while (length < count && length < MAX_BATCH_RUN && requests[length].op == op) {
+        const FileDescription* description = descriptorFor(requests[length]);
+        if (!description || description->node != node) {
+            break;
+        }
+        length++;
+    }
+    return length;
+}
+
+//caller holds the node's ioMutex and the namespace lock; returns how many succeeded
+size_t VirtualFileSystem::transferRun(VfsIoRequest* requests, size_t count){
+    bool writing = requests[0].op == VfsIoOp::WRITE;
+    Device* device = nullptr;
+    FileDescription* descriptions[MAX_BATCH_RUN];
+    IoVec iov[MAX_BATCH_RUN];
+    int results[MAX_BATCH_RUN];
+    size_t members[MAX_BATCH_RUN];
+    int segments = 0;
+
+    for (size_t index = 0; index < count; index++) {
+        FileDescription* description = descriptorFor(requests[index]);
+        if (!(description->flags & (writing ? VFS_O_WRONLY : VFS_O_RDONLY))) {
+            requests[index].result = VFS_ERROR_ACCESS;
+            continue;
+        }
+        device = description->node->device.get();
+        descriptions[segments] = description;
+        iov[segments].base = requests[index].buffer;
+        iov[segments].length = requests[index].size;
+        members[segments] = index;
+        segments++;
+    }
+    if (segments == 0) {
+        return 0;
+    }
+
+    if (writing) {
+        device->writeBatch(iov, results, segments);
+    }
+    else{
+        acknowledgeInterrupt(*descriptions[0]->node->readiness);
+        device->readBatch(iov, results, segments);
+    }
+
+    size_t succeeded = 0;
+    for (int segment = 0; segment < segments; segment++) {
+        VfsIoRequest& request = requests[members[segment]];
+        int result = results[segment];
+        //same rules as transfer()
+        if (result < 0 || (!writing && result == 0)) {
+            request.result = VFS_ERROR_DRIVER_FAIL;
+            continue;
+        }
+        descriptions[segment]->offset += static_cast<uint64_t>(result);
+        request.result = result;
+        succeeded++;
+    }
+    return succeeded;
+}
+
+AsyncIoEngine& VirtualFileSystem::getAsyncIo(){
+    lock_guard<mutex> lock(asyncIoMutex);
+    if (!asyncIo) {
+        asyncIo = make_unique<AsyncIoEngine>(*this);
+    }
+    return *asyncIo;
+}
+
+DmaController& VirtualFileSystem::getDma(){
+    lock_guard<mutex> lock(dmaMutex);
+    if (!dma) {
+        dma = make_unique<DmaController>(*this);
+    }
+    return *dma;
+}
+
+string VirtualFileSystem::getDevicePath(int fd) const {
+    shared_lock<shared_mutex> lock(namespaceMutex);
+    const FileDescription* description = descriptorFor(fd);
+    return description ? description->node->devicePath : "";
+}
+
+//the descriptor pins the node, so the device can't be unregistered under the check
+bool VirtualFileSystem::supportsDma(int fd) const {
+    shared_lock<shared_mutex> lock(namespaceMutex);
+    const FileDescription* description = descriptorFor(fd);
+    return description && description->node->device->supportsDma();
+}
+
+shared_ptr<DeviceReadiness> VirtualFileSystem::readinessFor(int fd) const {
+    shared_lock<shared_mutex> lock(namespaceMutex);
+    const FileDescription* description = descriptorFor(fd);
+    return description ? description->node->readiness : nullptr;
+}
+
+void VirtualFileSystem::notifyReadiness(DeviceReadiness& readiness){
+    lock_guard<mutex> watchLock(readiness.watchMutex);
+    for (const auto& watcher : readiness.watchers) {
+        watcher.first->markReady(watcher.second);
+    }
+    readiness.changed.notify_all();
+}
+
+//a read acknowledges the interrupt edge, like re-reading a sysfs gpio value after POLLPRI
+void VirtualFileSystem::acknowledgeInterrupt(DeviceReadiness& readiness){
+    if (readiness.events.load(memory_order_relaxed) & VFS_POLLPRI) {
+        readiness.events.fetch_and(~VFS_POLLPRI);
+    }
+}
+
+//returns the bits that ended the wait, errors and hangups always do
+uint32_t VirtualFileSystem::waitForEvents(DeviceReadiness& readiness, uint32_t events){
+    uint32_t mask = events | VFS_POLLERR | VFS_POLLHUP;
+    unique_lock<mutex> watchLock(readiness.watchMutex);
+    uint32_t current = 0;
+    readiness.changed.wait(watchLock, [&]{
+        current = readiness.events.load(memory_order_acquire) & mask;
+        return current != 0;
+    });
+    return current;
+}
+
+int VirtualFileSystem::signalDeviceEvent(const string& devicePath, uint32_t events){
+    shared_ptr<DeviceReadiness> readiness;
+    {
+        shared_lock<shared_mutex> lock(namespaceMutex);
+        auto it = deviceNodes.find(devicePath);
+        if (it == deviceNodes.end()) {
+            return VFS_ERROR_NOT_FOUND;
+        }
+        readiness = it->second->readiness;
+    }
+    //set under watchMutex so a waiter can't check the bits and then miss the wakeup
+    {
+        lock_guard<mutex> watchLock(readiness->watchMutex);
+        readiness->events.fetch_or(events);
+    }
+    notifyReadiness(*readiness);
+    return VFS_SUCCESS;
+}
+
+int VirtualFileSystem::clearDeviceEvent(const string& devicePath, uint32_t events){
+    shared_lock<shared_mutex> lock(namespaceMutex);
+    auto it = deviceNodes.find(devicePath);
+    if (it == deviceNodes.end()) {
+        return VFS_ERROR_NOT_FOUND;
+    }
+    it->second->readiness->events.fetch_and(~events);
+    return VFS_SUCCESS;
+}
+
+int VirtualFileSystem::poll(VfsPollFd* fds, size_t count, chrono::milliseconds timeout){
+    //the set holds each fd once, so an fd listed more than once is watched for the union of its
+    //entries' events and the result is fanned back out to every entry; negative fds are skipped
+    unordered_map<int, uint32_t> interest;
+    for (size_t index = 0; index < count; index++) {
+        fds[index].revents = 0;
+        if (fds[index].fd >= 0) {
+            interest[fds[index].fd] |= fds[index].events;
+        }
+    }
+    VfsPollSet pollSet(*this);
+    unordered_map<int, uint32_t> signalled;
+    for (const auto& pair : interest) {
+        if (pollSet.add(pair.first, pair.second, static_cast<uint64_t>(pair.first)) == VFS_ERROR_BAD_FD) {
+            signalled[pair.first] = VFS_POLLNVAL;
+        }
+    }
+    vector<VfsPollEvent> events(interest.size());
+    size_t woken = pollSet.wait(events.data(), events.size(), signalled.empty() ? timeout : chrono::milliseconds(0));
+    for (size_t index = 0; index < woken; index++) {
+        signalled[static_cast<int>(events[index].userData)] = events[index].events;
+    }
+
+    int ready = 0;
+    for (size_t index = 0; index < count; index++) {
+        auto it = signalled.find(fds[index].fd);
+        if (fds[index].fd < 0 || it == signalled.end()) {
+            continue;
+        }
+        uint32_t mask = fds[index].events | VFS_POLLERR | VFS_POLLHUP | VFS_POLLNVAL;
+        fds[index].revents = it->second & mask;
+        if (fds[index].revents) {
+            ready++;
+        }
+    }
+    return ready;
+}
+
 int VirtualFileSystem::readDevice(const string& devicePath, void* buffer, size_t size){
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
     auto it = deviceNodes.find(devicePath);
     if (it == deviceNodes.end()) {
-        logger.log(MessageType::VFS, "Device not found: " +devicePath );
+        VOS_LOG_RATE_LIMITED(logger, MessageType::VFS, "Device not found: " +devicePath );
         return -1;
     }
     auto& node = it->second;
-    if (!node->isOpen) {
-        logger.log(MessageType::VFS, "Device not open: "+devicePath);
+    if (!node->isOpen()) {
+        VOS_LOG_RATE_LIMITED(logger, MessageType::VFS, "Device not open: "+devicePath);
         return -2;
     }
-    string data = node->device->read();
-    if (data.empty()) {
+    //keep the last byte for the terminator
+    if (size == 0) {
+        return -3;
+    }
+    unique_lock<mutex> ioLock(node->ioMutex);
+    lock.unlock();
+    int result = node->device->read(buffer, size - 1);
+    if (result <= 0) {
         return -3;
     }
-    size_t toCopy = min(size-1, data.size());
-    memcpy(buffer, data.data(), toCopy);
-    static_cast<char*>(buffer)[toCopy] = '\0';
+    static_cast<char*>(buffer)[result] = '\0';
     updateLastAccess(*node);
-    return static_cast<int>(toCopy);
+    return result;
 }
 
 bool VirtualFileSystem::writeToDevice(const string& devicepath, const string& data){
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
 
     if (!validateDevicePath(devicepath)) {
         logger.log(MessageType::VFS, "Invalid device path: " + devicepath);
         return false;
     }
-    Device* device = findDevice(devicepath);
-    if (!device) {
-        logger.log(MessageType::VFS, "Device not found: " + devicepath);
+    auto it = deviceNodes.find(devicepath);
+    if (it == deviceNodes.end()) {
+        VOS_LOG_RATE_LIMITED(logger, MessageType::VFS, "Device not found: " + devicepath);
         return false;
     }
+    DeviceNode& node = *it->second;
+    Device* device = node.device.get();
+    unique_lock<mutex> ioLock(node.ioMutex);
+    lock.unlock();
     if (!device->isReady()) {
-        logger.log(MessageType::VFS, "Device not ready: " + devicepath);
+        VOS_LOG_RATE_LIMITED(logger, MessageType::VFS, "Device not ready: " + devicepath);
         return false;
     }
     logger.log(MessageType::VFS, "Writing to " + devicepath + " (" + to_string(data.length()) + " bytes)");
 
-    bool result = device->write(data);
+    bool result = device->write(data.data(), data.size()) >= 0;
     if (result) {
-        auto it = deviceNodes.find(devicepath);
-        if (it!= deviceNodes.find(devicepath)) {
-            updateLastAccess(*it->second);
-        }
+        updateLastAccess(node);
         logger.log(MessageType::VFS, "Write successful to " + devicepath);
     } else {
         logger.log(MessageType::VFS, "Write failed to " + devicepath);
@@ -262,21 +763,40 @@ bool VirtualFileSystem::writeToDevice(const string& devicepath, const string& da
     return result;
 }
 pair<string, bool> VirtualFileSystem::readFromDevice(const std::string& devicePath, bool blocking) {
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
     
     if (!validateDevicePath(devicePath)) {
         logger.log(MessageType::VFS, "Invalid device path: " + devicePath);
         return make_pair("", false);
     }
     
-    Device* device = findDevice(devicePath);
-    if (!device) {
-        logger.log(MessageType::VFS, "Device not found: " + devicePath);
+    auto it = deviceNodes.find(devicePath);
+    if (it == deviceNodes.end()) {
+        VOS_LOG_RATE_LIMITED(logger, MessageType::VFS, "Device not found: " + devicePath);
         return make_pair("", false);
     }
+    DeviceNode& node = *it->second;
+    Device* device = node.device.get();
+
+    //consume the readable edge; with nothing pending either give up or sleep until the device signals
+    if (node.readiness->signalled && !(node.readiness->events.fetch_and(~VFS_POLLIN) & VFS_POLLIN)) {
+        if (!blocking) {
+            VOS_LOG_RATE_LIMITED(logger, MessageType::VFS, "No data ready on " + devicePath);
+            return make_pair("", false);
+        }
+        shared_ptr<DeviceReadiness> readiness = node.readiness;
+        lock.unlock();
+        if (!(waitForEvents(*readiness, VFS_POLLIN) & VFS_POLLIN)) {
+            return make_pair("", false);
+        }
+        return readFromDevice(devicePath, blocking);
+    }
+
+    unique_lock<mutex> ioLock(node.ioMutex);
+    lock.unlock();
     
     if (!device->isReady()) {
-        logger.log(MessageType::VFS, "Device not ready: " + devicePath);
+        VOS_LOG_RATE_LIMITED(logger, MessageType::VFS, "Device not ready: " + devicePath);
         return make_pair("", false);
     }
     
@@ -287,11 +807,7 @@ pair<string, bool> VirtualFileSystem::readFromDevice(const std::string& devicePa
     bool success = !data.empty();
     
     if (success) {
-        // Update access time
-        auto it = deviceNodes.find(devicePath);
-        if (it != deviceNodes.end()) {
-            updateLastAccess(*it->second);
-        }
+        updateLastAccess(node);
         logger.log(MessageType::VFS, "Read successful from " + devicePath + 
                    " (" + to_string(data.length()) + " bytes)");
     } else {
@@ -301,23 +817,24 @@ pair<string, bool> VirtualFileSystem::readFromDevice(const std::string& devicePa
     return make_pair(data, success);
 }
 int VirtualFileSystem::writeDevice(const string& driverPath, const void* buffer, size_t size){
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
     auto it = deviceNodes.find(driverPath);
     if (it==deviceNodes.end()) {
         return -1;  
     } 
     auto& node = it->second;
-    if (!node->isOpen) {
+    if (!node->isOpen()) {
         return -2;
     }
-    string data(static_cast<const char*>(buffer), size);
-    bool result = node->device->write(data);
+    unique_lock<mutex> ioLock(node->ioMutex);
+    lock.unlock();
+    int result = node->device->write(buffer, size);
     updateLastAccess(*node);
-    return result ? static_cast<int>(size) : -3;
+    return result >= 0 ? result : -3;
 }
 
 int VirtualFileSystem::configureDevice(const string& devicePath, int parameter, int value){
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
 
     auto it = deviceNodes.find(devicePath);
     if (it==deviceNodes.end()) {
@@ -326,6 +843,8 @@ int VirtualFileSystem::configureDevice(const string& devicePath, int parameter,
     }
 
     auto& node = it->second;
+    unique_lock<mutex> ioLock(node->ioMutex);
+    lock.unlock();
     bool result = node->device->configure(parameter, value);
     updateLastAccess(*node);
 
@@ -333,12 +852,13 @@ int VirtualFileSystem::configureDevice(const string& devicePath, int parameter,
 }
 
 Device* VirtualFileSystem::findDevice(const std::string& devicePath) const {
+    shared_lock<shared_mutex> lock(namespaceMutex);
     auto it = deviceNodes.find(devicePath);
     return (it != deviceNodes.end()) ? it->second->device.get() : nullptr;
 }
 
 vector<string> VirtualFileSystem::listDevice() const{
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
 
     vector<string> deviceList;
     for (const auto& pair  : deviceNodes) {
@@ -348,12 +868,11 @@ vector<string> VirtualFileSystem::listDevice() const{
 }
 
 bool VirtualFileSystem::deviceExists(const string& devicePath) const {
-    // lock_guard<mutex> lock(vfsMutex);
     return deviceNodes.find(devicePath) != deviceNodes.end();
 }
 
 void VirtualFileSystem::displayDeviceTree() const{
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
 
     logger.log(MessageType::HEADER, "Virtual device tree");
     logger.log(MessageType::STATUS, devRoot+"/");
@@ -373,7 +892,7 @@ void VirtualFileSystem::displayDeviceTree() const{
         const auto& node = deviceNodes.at(path);
         string deviceName = path.substr(devRoot.length()+1);
 
-        string status = node->isOpen ? "[OPEN]" : "[CLOSED]";
+        string status = node->isOpen() ? "[OPEN x" + to_string(node->refCount) + "]" : "[CLOSED]";
         string accessInfo = "accessed " + to_string(node->openCount) + " times";
 
         logger.log(MessageType::STATUS, "  " + deviceName + " -> " + node->deviceName + " " + status + " (" + accessInfo + ")");
@@ -381,16 +900,16 @@ void VirtualFileSystem::displayDeviceTree() const{
 }
 
 size_t VirtualFileSystem::getDeviceCount() const{
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
     return deviceNodes.size();
 }
 
 vector<string> VirtualFileSystem::getOpenDevices() const {
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
     
     vector<string> openDevices;
     for (const auto& pair : deviceNodes) {
-        if (pair.second->isOpen) {
+        if (pair.second->isOpen()) {
             openDevices.push_back(pair.first);
         }
     }
@@ -399,7 +918,7 @@ vector<string> VirtualFileSystem::getOpenDevices() const {
 }
 
 void VirtualFileSystem::displayVFSStatistics() const {
-    lock_guard<mutex> lock(vfsMutex);
+    shared_lock<shared_mutex> lock(namespaceMutex);
     
     logger.log(MessageType::HEADER, "VFS Statistics");
     
@@ -408,7 +927,7 @@ void VirtualFileSystem::displayVFSStatistics() const {
     int totalAccesses = 0;
     
     for (const auto& pair : deviceNodes) {
-        if (pair.second->isOpen) {
+        if (pair.second->isOpen()) {
             openDevices++;
         }
         totalAccesses += pair.second->openCount;
@@ -418,6 +937,14 @@ void VirtualFileSystem::displayVFSStatistics() const {
     logger.log(MessageType::STATUS, "Open devices: " + to_string(openDevices));
     logger.log(MessageType::STATUS, "Closed devices: " + to_string(totalDevices - openDevices));
     logger.log(MessageType::STATUS, "Total accesses: " + to_string(totalAccesses));
+
+    int openDescriptors = 0;
+    for (const auto& description : descriptorTable) {
+        if (description.node) {
+            openDescriptors++;
+        }
+    }
+    logger.log(MessageType::STATUS, "Open descriptors: " + to_string(openDescriptors) + "/" + to_string(MAX_OPEN_FILES));
     
     if (totalDevices > 0) {
         float avgAccesses = static_cast<float>(totalAccesses) / totalDevices;
@@ -4,32 +4,106 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <chrono>
+#include <cstdint>
 #include "Device.h"
+#include "VfsPoll.h"
 class Device;
 class LoadedDriver;
 class Logger;
+class AsyncIoEngine;
+class DmaController;
 using namespace std;
 struct DeviceNode {
     string devicePath;
     string deviceName;
     unique_ptr<Device> device;
-    bool isOpen;
     chrono::steady_clock::time_point lastAccess;
+    //refCount - descriptors currently open on the node, openCount - opens since registration
+    int refCount;
     int openCount;
+    //serialises I/O on this device and guards lastAccess and the offsets of descriptors on it
+    mutex ioMutex;
+    shared_ptr<DeviceReadiness> readiness;
     DeviceNode(const string& path, const string& name, unique_ptr<Device> dev)
-        : devicePath(path), deviceName(name), device(std::move(dev)), isOpen(false), openCount(0) {
+        : devicePath(path), deviceName(name), device(std::move(dev)), refCount(0), openCount(0),
+          readiness(make_shared<DeviceReadiness>()) {
         lastAccess = chrono::steady_clock::now();
     }
+    bool isOpen() const {return refCount > 0;}
+};
+
+//one open of a device, fds index straight into the descriptor table
+struct FileDescription {
+    DeviceNode* node = nullptr;
+    int flags = 0;
+    //bytes moved through this descriptor, devices are streams so it only ever grows
+    uint64_t offset = 0;
+    //tells this open apart from later ones that get the same fd number
+    uint64_t generation = 0;
+};
+
+enum class VfsIoOp{
+    READ,
+    WRITE,
+    READV,
+    WRITEV
+};
+
+//one entry of a batch submission; result is filled in with bytes moved or a VFS_ERROR_* code
+struct VfsIoRequest {
+    VfsIoOp op = VfsIoOp::READ;
+    int fd = -1;
+    //READ/WRITE use buffer + size, READV/WRITEV use iov + iovcnt
+    void* buffer = nullptr;
+    size_t size = 0;
+    const IoVec* iov = nullptr;
+    int iovcnt = 0;
+    //non-zero pins the request to that open of fd, a reused fd number fails with VFS_ERROR_BAD_FD
+    uint64_t generation = 0;
+    int result = 0;
 };
 
 class VirtualFileSystem {
+    friend class VfsPollSet;
+
     private:
         Logger& logger;
         unordered_map<string, unique_ptr<DeviceNode>> deviceNodes;
         string devRoot = "/dev";
-        mutable mutex vfsMutex;
+        //exclusive for anything that changes deviceNodes or the descriptor table (register, open, close),
+        //shared for lookups only; I/O swaps it for the node's ioMutex so different devices run in parallel
+        //lock order is always namespaceMutex then ioMutex
+        mutable shared_mutex namespaceMutex;
         bool initialized;
+
+        static constexpr int MAX_OPEN_FILES = 64;
+        FileDescription descriptorTable[MAX_OPEN_FILES];
+        uint64_t nextGeneration = 1;
+
+        mutex asyncIoMutex;
+        unique_ptr<AsyncIoEngine> asyncIo;
+        mutex dmaMutex;
+        unique_ptr<DmaController> dma;
+
+        FileDescription* descriptorFor(int fd);
+        const FileDescription* descriptorFor(int fd) const;
+        FileDescription* descriptorFor(const VfsIoRequest& request);
+        const FileDescription* descriptorFor(const VfsIoRequest& request) const;
+        //DMA channels keep their own descriptor on the device, shut them before it is closed under them
+        int closeDmaChannels(const string& devicePath);
+        void releaseDescriptor(int fd);
+        int closeDescriptorsFor(DeviceNode* node);
+        void drainNode(DeviceNode& node);
+        int transfer(FileDescription& description, const VfsIoRequest& request);
+        static constexpr size_t MAX_BATCH_RUN = 16;
+        size_t batchRunLength(const VfsIoRequest* requests, size_t count, DeviceNode* node) const;
+        size_t transferRun(VfsIoRequest* requests, size_t count);
+        shared_ptr<DeviceReadiness> readinessFor(int fd) const;
+        void notifyReadiness(DeviceReadiness& readiness);
+        void acknowledgeInterrupt(DeviceReadiness& readiness);
+        uint32_t waitForEvents(DeviceReadiness& readiness, uint32_t events);
     public:
         explicit VirtualFileSystem(Logger& log);
         ~VirtualFileSystem();
@@ -42,9 +116,42 @@ class VirtualFileSystem {
 
         bool unregisterDevice(const string& devicePath);
 
-        int openDevice(const string& devicePath);
+        //returns the lowest free fd (>= 0) or a VFS_ERROR_* code, generation is set to this open's generation
+        int openDevice(const string& devicePath, int flags = VFS_O_RDWR, uint64_t* generation = nullptr);
+        //closes every descriptor open on the device, DMA channels on it included
         int closeDevice(const string& devicePath);
 
+        //descriptor based I/O, no path lookup; return bytes moved or a VFS_ERROR_* code
+        int read(int fd, void* buffer, size_t size);
+        int write(int fd, const void* buffer, size_t size);
+        int ioctl(int fd, int parameter, int value);
+        //a non-zero generation only closes that open of fd
+        int close(int fd, uint64_t generation = 0);
+        int64_t tell(int fd) const;
+        int readv(int fd, const IoVec* iov, int iovcnt);
+        int writev(int fd, const IoVec* iov, int iovcnt);
+
+        //runs the requests in order under one namespace lock and one clock read,
+        //consecutive requests on the same device share its lock and back-to-back plain reads or
+        //writes on it reach the driver as one batch; returns how many succeeded
+        size_t submitBatch(VfsIoRequest* requests, size_t count);
+
+        //submission/completion queues over the descriptor calls, started on first use
+        AsyncIoEngine& getAsyncIo();
+        //descriptor-ring DMA for devices whose driver advertises DRIVER_CAP_DMA, started on first use
+        DmaController& getDma();
+        //"" for a bad fd
+        string getDevicePath(int fd) const;
+        //false for a bad fd or a device whose driver doesn't advertise DRIVER_CAP_DMA
+        bool supportsDma(int fd) const;
+
+        //readiness edges from devices and driver callbacks, wake anything polling or blocked on them
+        int signalDeviceEvent(const string& devicePath, uint32_t events);
+        int clearDeviceEvent(const string& devicePath, uint32_t events);
+        //POSIX poll over descriptors, returns how many entries have revents set, 0 on timeout;
+        //a negative timeout waits until something is ready
+        int poll(VfsPollFd* fds, size_t count, chrono::milliseconds timeout);
+
         int readDevice(const string& devicePath, void* buffer, size_t size);
         int writeDevice(const string& devicePath, const void* buffer, size_t size);
         int configureDevice(const string& devicePath, int parameter, int value);
@@ -56,7 +163,7 @@ class VirtualFileSystem {
         vector<string> getOpenDevices() const;
         void displayVFSStatistics() const;
 
-        string generateDevicePath(const string& driverName);
+        string generateDevicePath(const string& driverName, int instance = 0);
         bool validateDevicePath(const string& devicePath) const;
         void updateLastAccess(DeviceNode& node);
 
@@ -71,4 +178,21 @@ class VirtualFileSystem {
         static constexpr int VFS_ERROR_DRIVER_FAIL = -3;
         static constexpr int VFS_ERROR_INVALID_PATH = -4;
         static constexpr int VFS_ERROR_ALREADY_OPEN = -5;
+        static constexpr int VFS_ERROR_BAD_FD = -6;
+        static constexpr int VFS_ERROR_TOO_MANY_OPEN = -7;
+        static constexpr int VFS_ERROR_ACCESS = -8;
+        static constexpr int VFS_ERROR_WOULD_BLOCK = -9;
+
+        static constexpr int VFS_O_RDONLY = 1;
+        static constexpr int VFS_O_WRONLY = 2;
+        static constexpr int VFS_O_RDWR = VFS_O_RDONLY | VFS_O_WRONLY;
+        static constexpr int VFS_O_NONBLOCK = 4;
+
+        static constexpr uint32_t VFS_POLLIN = 0x001;
+        //exceptional event, set by the device's interrupt and cleared by the next read
+        static constexpr uint32_t VFS_POLLPRI = 0x002;
+        static constexpr uint32_t VFS_POLLOUT = 0x004;
+        static constexpr uint32_t VFS_POLLERR = 0x008;
+        static constexpr uint32_t VFS_POLLHUP = 0x010;
+        static constexpr uint32_t VFS_POLLNVAL = 0x020;
 };
@@ -45,22 +45,22 @@ int main(int argc, char* argv[]) {
         string testDevice = deviceList[0];
         logger.log(MessageType::INFO, "Testing device: " + testDevice);
 
-        int openResult = vfs.openDevice(testDevice);
-        logger.log(MessageType::INFO, "Open " + testDevice + ": " + (openResult == 0 ? "SUCCESS" : "FAILED(" + to_string(openResult) + ")"));
+        int fd = vfs.openDevice(testDevice);
+        logger.log(MessageType::INFO, "Open " + testDevice + ": " + (fd >= 0 ? "SUCCESS (fd " + to_string(fd) + ")" : "FAILED(" + to_string(fd) + ")"));
 
-        if (openResult == 0) {
-            int configResult = vfs.configureDevice(testDevice, 1, 115200);
+        if (fd >= 0) {
+            int configResult = vfs.ioctl(fd, 1, 115200);
             logger.log(MessageType::INFO, "Configure " + testDevice + ": " + (configResult == 0 ? "SUCCESS" : "FAILED(" + to_string(configResult) + ")"));
 
             string testData = "Hello from vOS!";
-            int writeResult = vfs.writeDevice(testDevice, testData.c_str(), testData.length());
+            int writeResult = vfs.write(fd, testData.c_str(), testData.length());
             logger.log(MessageType::INFO, "Write to " + testDevice + ": " + (writeResult > 0 ? to_string(writeResult) + " bytes" : "FAILED(" + to_string(writeResult) + ")"));
 
             char buffer[64] = {0};
-            int readResult = vfs.readDevice(testDevice, buffer, sizeof(buffer));
+            int readResult = vfs.read(fd, buffer, sizeof(buffer) - 1);
             logger.log(MessageType::INFO, "Read from " + testDevice + ": " + (readResult > 0 ? to_string(readResult) + " bytes" : "FAILED(" + to_string(readResult) + ")"));
 
-            int closeResult = vfs.closeDevice(testDevice);
+            int closeResult = vfs.close(fd);
             logger.log(MessageType::INFO, "Close " + testDevice + ": " + (closeResult == 0 ? "SUCCESS" : "FAILED(" + to_string(closeResult) + ")"));
         }
     }
@@ -72,7 +72,7 @@ int main(int argc, char* argv[]) {
     }
     for (const auto& device : testDevices) {
         int result = vfs.openDevice(device);
-        logger.log(MessageType::INFO, "Batch open " + device + ": " + (result == 0 ? "SUCCESS" : "FAILED"));
+        logger.log(MessageType::INFO, "Batch open " + device + ": " + (result >= 0 ? "SUCCESS (fd " + to_string(result) + ")" : "FAILED"));
     }
     auto openDevices = vfs.getOpenDevices();
     logger.log(MessageType::INFO, "Currently open devices: " + to_string(openDevices.size()));
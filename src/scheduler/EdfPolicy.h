@@ -0,0 +1,32 @@
+#pragma once
+#include "SchedulingPolicy.h"
+#include "TaskHeap.h"
+#include "TCB.h"
+
+using namespace std;
+
+//Earliest-Deadline-First: smallest absolute deadline runs first, Priority breaks ties
+class EdfPolicy : public SchedulingPolicy{
+    private:
+        struct EarlierDeadline{
+            bool operator()(const TCB* a, const TCB* b) const {
+                if (a->getAbsoluteDeadline() != b->getAbsoluteDeadline()) {
+                    return a->getAbsoluteDeadline() < b->getAbsoluteDeadline();
+                }
+                return static_cast<int>(a->getPriority()) > static_cast<int>(b->getPriority());
+            }
+        };
+
+        TaskHeap<EarlierDeadline> deadlineHeap;
+
+    public:
+        string getName() const override {return "EDF";}
+
+        bool enqueue(TCB* task) override {return deadlineHeap.push(task);}
+        TCB* dequeue() override {return deadlineHeap.pop();}
+        bool remove(TCB* task) override {return deadlineHeap.remove(task);}
+
+        bool empty() const override {return deadlineHeap.empty();}
+        size_t size() const override {return deadlineHeap.size();}
+        vector<TCB*> snapshot() const override {return deadlineHeap.snapshot();}
+};
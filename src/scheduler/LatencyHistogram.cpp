@@ -0,0 +1,91 @@
+#include "LatencyHistogram.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+    //index of the highest set bit, value must be non-zero
+    int highestBit(uint64_t value){
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+}
+
+LatencyHistogram::LatencyHistogram() : maxValue(0){
+    for (int index = 0; index < BUCKET_COUNT; index++) {
+        counts[index].store(0, memory_order_relaxed);
+    }
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value){
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+    int msb = highestBit(value);
+    if (msb >= MAX_VALUE_BITS) {
+        return BUCKET_COUNT - 1;
+    }
+    int shift = msb - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index){
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t subBucket = static_cast<uint64_t>(index % SUB_BUCKETS);
+    return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value){
+    counts[bucketIndex(value)].fetch_add(1, memory_order_relaxed);
+
+    uint64_t currentMax = maxValue.load(memory_order_relaxed);
+    while (value > currentMax && !maxValue.compare_exchange_weak(currentMax, value, memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot copy;
+    copy.totalCount = 0;
+    for (int index = 0; index < BUCKET_COUNT; index++) {
+        copy.counts[index] = counts[index].load(memory_order_relaxed);
+        copy.totalCount += copy.counts[index];
+    }
+    copy.maxValue = maxValue.load(memory_order_relaxed);
+    return copy;
+}
+
+void LatencyHistogram::reset(){
+    for (int index = 0; index < BUCKET_COUNT; index++) {
+        counts[index].store(0, memory_order_relaxed);
+    }
+    maxValue.store(0, memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double percent) const {
+    if (totalCount == 0) {
+        return 0;
+    }
+    //rank of the sample we are after, 1-based
+    uint64_t rank = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(totalCount) + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (int index = 0; index < BUCKET_COUNT; index++) {
+        seen += counts[index];
+        if (seen >= rank) {
+            uint64_t upper = bucketUpperBound(index);
+            return upper < maxValue ? upper : maxValue;
+        }
+    }
+    return maxValue;
+}
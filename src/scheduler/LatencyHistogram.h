@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+//log-linear buckets: 8 linear sub-buckets per power of two, so any recorded value
+//is reported within 12.5% of its true value. covers 0 .. 2^32-1 us, larger values clamp
+class LatencyHistogram{
+    public:
+        static constexpr int SUB_BUCKET_BITS = 3;
+        static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static constexpr int MAX_VALUE_BITS = 32;
+        static constexpr int BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        struct Snapshot{
+            uint32_t counts[BUCKET_COUNT];
+            uint64_t totalCount;
+            uint64_t maxValue;
+
+            //highest value that falls into the same bucket as the requested percentile (0..100)
+            uint64_t percentile(double percent) const;
+        };
+
+    private:
+        atomic<uint32_t> counts[BUCKET_COUNT];
+        atomic<uint64_t> maxValue;
+
+    public:
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator = (const LatencyHistogram&) = delete;
+
+        //wait-free, safe to call from any thread
+        void record(uint64_t value);
+        //lock-free read, counts recorded concurrently may or may not be included
+        Snapshot snapshot() const;
+        void reset();
+
+        static int bucketIndex(uint64_t value);
+        static uint64_t bucketUpperBound(int index);
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+using namespace std;
+
+//unbounded multi-producer/single-consumer queue (Vyukov)
+//push is one exchange + one store, no locks and no CAS loops
+//pop may briefly see the queue as empty while a producer is between its two steps,
+//the element shows up on the next pop
+template<typename T>
+class MpscQueue{
+    private:
+        struct Node{
+            atomic<Node*> next;
+            T value;
+
+            Node() : next(nullptr){}
+            explicit Node(T&& item) : next(nullptr), value(std::move(item)){}
+        };
+
+        //producers swing head, the consumer owns tail (always a drained stub node)
+        alignas(64) atomic<Node*> head;
+        alignas(64) Node* tail;
+
+    public:
+        MpscQueue(){
+            Node* stub = new Node();
+            head.store(stub, memory_order_relaxed);
+            tail = stub;
+        }
+
+        ~MpscQueue(){
+            T discarded;
+            while (pop(discarded)) {}
+            delete tail;
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator = (const MpscQueue&) = delete;
+
+        void push(T item){
+            Node* node = new Node(std::move(item));
+            Node* previous = head.exchange(node, memory_order_acq_rel);
+            previous->next.store(node, memory_order_release);
+        }
+
+        //consumer thread only
+        bool pop(T& item){
+            Node* next = tail->next.load(memory_order_acquire);
+            if (!next) {
+                return false;
+            }
+            item = std::move(next->value);
+            delete tail;
+            tail = next;
+            return true;
+        }
+
+        bool empty() const {
+            return tail->next.load(memory_order_acquire) == nullptr;
+        }
+};
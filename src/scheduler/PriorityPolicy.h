@@ -0,0 +1,22 @@
+#pragma once
+#include "SchedulingPolicy.h"
+#include "ReadyQueue.h"
+
+using namespace std;
+
+//three-level Priority, round-robin inside a level
+class PriorityPolicy : public SchedulingPolicy{
+    private:
+        ReadyQueue readyQueue;
+
+    public:
+        string getName() const override {return "PRIORITY";}
+
+        bool enqueue(TCB* task) override {return readyQueue.push(task);}
+        TCB* dequeue() override {return readyQueue.popHighest();}
+        bool remove(TCB* task) override {return readyQueue.remove(task);}
+
+        bool empty() const override {return readyQueue.empty();}
+        size_t size() const override {return readyQueue.size();}
+        vector<TCB*> snapshot() const override {return readyQueue.snapshot();}
+};
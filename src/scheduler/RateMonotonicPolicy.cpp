@@ -0,0 +1,80 @@
+#include "RateMonotonicPolicy.h"
+#include "../kernel/Clock.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+    struct TaskTiming{
+        const TCB* task;
+        int64_t period;
+        int64_t deadline;
+        int64_t cost;
+    };
+
+    //one job holds the CPU for whole ticks: the sequential dispatcher runs one task per tick
+    int64_t costInTicks(const TCB& task){
+        int64_t tickMicroseconds = chrono::duration_cast<chrono::microseconds>(Clock::TICK_INTERVALS).count();
+        int64_t wcet = task.getWorstCaseExecutionTime().count();
+        return max<int64_t>(1, (wcet + tickMicroseconds - 1) / tickMicroseconds);
+    }
+}
+
+//Liu & Layland utilisation bound first when every deadline equals its period, exact response-time
+//analysis when the bound is inconclusive or doesn't apply:
+//R = C_i + sum over higher-priority j of ceil(R / T_j) * C_j, iterated until it settles or passes D_i
+bool RateMonotonicPolicy::admit(const TCB& candidate, const vector<const TCB*>& admittedTasks, string& reason) const {
+    vector<TaskTiming> taskSet;
+    taskSet.reserve(admittedTasks.size() + 1);
+    for (const TCB* task : admittedTasks) {
+        taskSet.push_back({task, task->getEffectiveWaitTicks(), task->getEffectiveRelativeDeadline(), costInTicks(*task)});
+    }
+    taskSet.push_back({&candidate, candidate.getEffectiveWaitTicks(), candidate.getEffectiveRelativeDeadline(), costInTicks(candidate)});
+
+    double utilization = 0.0;
+    //the Liu & Layland bound assumes implicit deadlines (D == T), a tighter one needs the exact test
+    bool implicitDeadlines = true;
+    for (const auto& timing : taskSet) {
+        utilization += static_cast<double>(timing.cost) / timing.period;
+        if (timing.deadline != timing.period) {
+            implicitDeadlines = false;
+        }
+    }
+    if (utilization > 1.0) {
+        reason = "utilization " + to_string(utilization) + " exceeds 1.0";
+        return false;
+    }
+    double n = static_cast<double>(taskSet.size());
+    double bound = n * (pow(2.0, 1.0 / n) - 1.0);
+    if (implicitDeadlines && utilization <= bound) {
+        return true;
+    }
+
+    sort(taskSet.begin(), taskSet.end(), [](const TaskTiming& a, const TaskTiming& b){ return a.period < b.period; });
+    for (size_t i = 0; i < taskSet.size(); i++) {
+        const TaskTiming& current = taskSet[i];
+        int64_t response = current.cost;
+        while (true) {
+            int64_t next = current.cost;
+            //equal periods interfere both ways, which keeps the test conservative
+            for (size_t j = 0; j < taskSet.size(); j++) {
+                if (j == i || taskSet[j].period > current.period) {
+                    continue;
+                }
+                next += ((response + taskSet[j].period - 1) / taskSet[j].period) * taskSet[j].cost;
+            }
+            if (next > current.deadline) {
+                reason = current.task->getName() + " response time " + to_string(next) +
+                         " ticks exceeds its deadline of " + to_string(current.deadline) + " ticks";
+                return false;
+            }
+            if (next == response) {
+                break;
+            }
+            response = next;
+        }
+    }
+    return true;
+}
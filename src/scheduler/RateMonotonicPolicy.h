@@ -0,0 +1,36 @@
+#pragma once
+#include "SchedulingPolicy.h"
+#include "TaskHeap.h"
+#include "TCB.h"
+
+using namespace std;
+
+//Rate-Monotonic: the shorter the period (waitTicks) the higher the priority,
+//new tasks are only admitted if response-time analysis shows every deadline is still met
+class RateMonotonicPolicy : public SchedulingPolicy{
+    private:
+        struct ShorterPeriod{
+            bool operator()(const TCB* a, const TCB* b) const {
+                if (a->getEffectiveWaitTicks() != b->getEffectiveWaitTicks()) {
+                    return a->getEffectiveWaitTicks() < b->getEffectiveWaitTicks();
+                }
+                return static_cast<int>(a->getPriority()) > static_cast<int>(b->getPriority());
+            }
+        };
+
+        TaskHeap<ShorterPeriod> periodHeap;
+
+    public:
+        string getName() const override {return "RATE_MONOTONIC";}
+
+        bool enqueue(TCB* task) override {return periodHeap.push(task);}
+        TCB* dequeue() override {return periodHeap.pop();}
+        bool remove(TCB* task) override {return periodHeap.remove(task);}
+
+        bool empty() const override {return periodHeap.empty();}
+        size_t size() const override {return periodHeap.size();}
+        vector<TCB*> snapshot() const override {return periodHeap.snapshot();}
+
+        bool hasAdmissionControl() const override {return true;}
+        bool admit(const TCB& candidate, const vector<const TCB*>& admittedTasks, string& reason) const override;
+};
@@ -0,0 +1,115 @@
+#include "ReadyQueue.h"
+#include "TCB.h"
+
+using namespace std;
+
+ReadyQueue::ReadyQueue() : readyBitmap(0), queuedCount(0){
+    for (int level = 0; level < PRIORITY_LEVELS; level++) {
+        heads[level] = nullptr;
+        tails[level] = nullptr;
+    }
+}
+
+int ReadyQueue::highestReadyLevel() const {
+    for (int level = PRIORITY_LEVELS - 1; level >= 0; level--) {
+        if (readyBitmap & (1u << level)) {
+            return level;
+        }
+    }
+    return -1;
+}
+
+bool ReadyQueue::push(TCB* task){
+    if (!task || task->readyLevel >= 0) {
+        return false;
+    }
+    int level = levelOf(task->getPriority());
+
+    task->readyNext = nullptr;
+    task->readyPrev = tails[level];
+    if (tails[level]) {
+        tails[level]->readyNext = task;
+    }
+    else{
+        heads[level] = task;
+    }
+    tails[level] = task;
+    task->readyLevel = level;
+
+    readyBitmap |= (1u << level);
+    queuedCount++;
+    return true;
+}
+
+TCB* ReadyQueue::popHighest(){
+    int level = highestReadyLevel();
+    if (level < 0) {
+        return nullptr;
+    }
+    TCB* task = heads[level];
+    remove(task);
+    return task;
+}
+
+bool ReadyQueue::remove(TCB* task){
+    if (!task || task->readyLevel < 0) {
+        return false;
+    }
+    //use the level it was queued at, priority may have changed since
+    int level = task->readyLevel;
+
+    if (task->readyPrev) {
+        task->readyPrev->readyNext = task->readyNext;
+    }
+    else{
+        heads[level] = task->readyNext;
+    }
+    if (task->readyNext) {
+        task->readyNext->readyPrev = task->readyPrev;
+    }
+    else{
+        tails[level] = task->readyPrev;
+    }
+
+    task->readyNext = nullptr;
+    task->readyPrev = nullptr;
+    task->readyLevel = -1;
+
+    if (!heads[level]) {
+        readyBitmap &= ~(1u << level);
+    }
+    queuedCount--;
+    return true;
+}
+
+bool ReadyQueue::contains(const TCB* task) const {
+    return task && task->readyLevel >= 0;
+}
+
+vector<TCB*> ReadyQueue::snapshot() const {
+    vector<TCB*> ordered;
+    ordered.reserve(queuedCount);
+    for (int level = PRIORITY_LEVELS - 1; level >= 0; level--) {
+        for (TCB* task = heads[level]; task; task = task->readyNext) {
+            ordered.push_back(task);
+        }
+    }
+    return ordered;
+}
+
+void ReadyQueue::clear(){
+    for (int level = 0; level < PRIORITY_LEVELS; level++) {
+        TCB* task = heads[level];
+        while (task) {
+            TCB* next = task->readyNext;
+            task->readyNext = nullptr;
+            task->readyPrev = nullptr;
+            task->readyLevel = -1;
+            task = next;
+        }
+        heads[level] = nullptr;
+        tails[level] = nullptr;
+    }
+    readyBitmap = 0;
+    queuedCount = 0;
+}
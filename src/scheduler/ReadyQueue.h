@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "TaskTypes.h"
+
+using namespace std;
+
+class TCB;
+
+//per-priority intrusive FIFO lists + bitmap of non-empty levels
+//push/pop/remove are O(1) and never allocate, the links live inside the TCB
+class ReadyQueue{
+    private:
+        static constexpr int PRIORITY_LEVELS = 3;
+
+        TCB* heads[PRIORITY_LEVELS];
+        TCB* tails[PRIORITY_LEVELS];
+        uint32_t readyBitmap;
+        size_t queuedCount;
+
+        static int levelOf(Priority priority) {return static_cast<int>(priority);}
+        int highestReadyLevel() const;
+
+    public:
+        ReadyQueue();
+
+        bool push(TCB* task);
+        TCB* popHighest();
+        bool remove(TCB* task);
+        bool contains(const TCB* task) const;
+
+        bool empty() const {return queuedCount == 0;}
+        size_t size() const {return queuedCount;}
+        bool hasReadyAtPriority(Priority priority) const {
+            return (readyBitmap & (1u << levelOf(priority))) != 0;
+        }
+
+        //highest priority first, FIFO inside each level (diagnostics only)
+        vector<TCB*> snapshot() const;
+        void clear();
+};
@@ -1,5 +1,4 @@
 #include "Scheduler.h"
-#include <iterator>
 #include<unordered_map>
 #include<string>
 #include<memory>
@@ -11,10 +10,25 @@
 #include <vector>
 #include "TCB.h"
 #include"TaskTypes.h"
+#include "PriorityPolicy.h"
+#include "../kernel/Clock.h"
 #include <algorithm>
 
 using namespace std;
 
+Scheduler::Scheduler() : schedulingPolicy(make_unique<PriorityPolicy>()), timerOverheadMicroseconds(0), totalTimerMicroseconds(0), timerUpdateCount(0),
+    pendingBottomHalves(0), bottomHalfSleeping(false), bottomHalfStarted(false), bottomHalfStopping(false), bottomHalfCount(0){}
+
+Scheduler::~Scheduler(){
+    stopBottomHalves();
+    disableParallelExecution();
+    //nobody is left to apply them, fail whatever is still queued
+    SchedulerCommand command;
+    while (pendingCommands.pop(command)) {
+        command.result.set_value(false);
+    }
+}
+
 bool Scheduler::isValidTask(const unique_ptr<TCB>& task) const{
 
     if (!task) {
@@ -31,66 +45,118 @@ bool Scheduler::isValidTask(const unique_ptr<TCB>& task) const{
 
 bool Scheduler::registerTask(unique_ptr<TCB> task){
     lock_guard<mutex> lock(schedulerMutex);
+    return registerTaskLocked(std::move(task));
+}
+
+bool Scheduler::registerTaskLocked(unique_ptr<TCB> task){
     if(!isValidTask(task)){
         Kernel::getInstance().getLogger().log(MessageType::ERRORS, "Task validation failed");
         return false;
     }
     string taskName = task->getName();
-    if (registeredTasks.find(taskName) != registeredTasks.end()) {
+    if (taskTable.findByName(taskName)) {
         Kernel::getInstance().getLogger().log(MessageType::ERRORS, "Task name is duplicate for :" + taskName);
         return false;
     }
 
-    registeredTasks[taskName] = std::move(task);
+    string rejectionReason;
+    if (!admitTask(*task, rejectionReason)) {
+        Kernel::getInstance().getLogger().log(MessageType::ERRORS, 
+            "Task admission rejected by " + schedulingPolicy->getName() + " for " + taskName + ": " + rejectionReason);
+        return false;
+    }
+
+    //the TCB moves into the slab, only the stored copy is linked into the queues
+    TCB* stored = taskTable.insert(std::move(*task));
+    if (!stored) {
+        Kernel::getInstance().getLogger().log(MessageType::ERRORS, "Task id is already in use for :" + taskName);
+        return false;
+    }
+    if (stored->getState() == TaskState::READY) {
+        makeTaskReady(stored);
+    }
+    if (stored->isCountDownLoggingEnabled()) {
+        countdownTasks.push_back(stored);
+    }
     Kernel::getInstance().getLogger().log(MessageType::INFO, "Task registered successfully: " + taskName);
     return true;
 }
+bool Scheduler::admitTask(const TCB& candidate, string& reason) const {
+    if (!schedulingPolicy->hasAdmissionControl()) {
+        return true;
+    }
+    vector<const TCB*> admittedTasks;
+    admittedTasks.reserve(taskTable.size());
+    taskTable.forEach([&](const TCB& admitted) {
+        if (&admitted != &candidate) {
+            admittedTasks.push_back(&admitted);
+        }
+    });
+    return schedulingPolicy->admit(candidate, admittedTasks, reason);
+}
+
 bool Scheduler::isTaskRegistered(const string& name) const {
     lock_guard<mutex> lock(schedulerMutex);
-    return registeredTasks.find(name) != registeredTasks.end();
+    return taskTable.findByName(name) != nullptr;
+}
+
+TCB* Scheduler::createTask(const string& name, Priority priority, function<void()> callback, int waitPeriod){
+    auto task = make_unique<TCB>(name, priority, std::move(callback), waitPeriod);
+    uint32_t taskId = task->getId();
+    if (!registerTask(std::move(task))) {
+        return nullptr;
+    }
+    return findTaskById(taskId);
 }
 
 TCB* Scheduler::findTaskByName(const string& name) const{
     lock_guard<mutex> lock(schedulerMutex);
-    auto it = registeredTasks.find(name);
-    if(it != registeredTasks.end() ){
-        return it->second.get();
-    }
-    return nullptr;
+    return taskTable.findByName(name);
+}
+
+TCB* Scheduler::findTaskById(uint32_t taskId) const{
+    lock_guard<mutex> lock(schedulerMutex);
+    return taskTable.findById(taskId);
 }
 
 void Scheduler::getAllRegisteredTasks() const{
     lock_guard<mutex> lock(schedulerMutex);
     
-    if (registeredTasks.empty()) {
+    if (taskTable.empty()) {
         Kernel::getInstance().getLogger().log(MessageType::INFO, "no task registered");
         return;
     }
     Kernel::getInstance().getLogger().log(MessageType::HEADER, "Registered Tasks");
 
-    for(const auto& it : registeredTasks){
-        const string& name = it.first;
-        const unique_ptr<TCB>& task = it.second;
-
+    taskTable.forEach([](const TCB& task) {
         Kernel::getInstance().getLogger().log(MessageType::INFO, 
-                                            "Task: " + name + 
-                                                    " (ID: " + to_string(task->getId()) + 
-                                                    ", Priority: " + task->getPriorityString() + 
-                                                    ", State: " + task->getStateString() + ")");
-        
-    }
+                                            "Task: " + task.getName() + 
+                                                    " (ID: " + to_string(task.getId()) + 
+                                                    ", Priority: " + task.getPriorityString() + 
+                                                    ", State: " + task.getStateString() + ")");
+    });
 }
 
 int Scheduler::getNumberOfRegisteredTasks() const{
     lock_guard<mutex> lock(schedulerMutex);
-    return static_cast<int>(registeredTasks.size());
+    return static_cast<int>(taskTable.size());
 }
 
 bool Scheduler::unregisterTask(const string& name){
     lock_guard<mutex> lock(schedulerMutex);
-    auto it = registeredTasks.find(name);
-    if (it != registeredTasks.end()) {
-        registeredTasks.erase(it);
+    return unregisterTaskLocked(name);
+}
+
+bool Scheduler::unregisterTaskLocked(const string& name){
+    TCB* task = taskTable.findByName(name);
+    if (task) {
+        if (task->getState() == TaskState::RUNNING) {
+            task->markRemovalPending();
+            Kernel::getInstance().getLogger().log(MessageType::INFO, 
+                "Task unregistered after current run: " + name);
+            return true;
+        }
+        releaseTask(task);
         Kernel::getInstance().getLogger().log(MessageType::INFO, 
             "Task unregistered: " + name);
         return true;
@@ -101,10 +167,17 @@ bool Scheduler::unregisterTask(const string& name){
     return false;
 }
 
+void Scheduler::releaseTask(TCB* task){
+    schedulingPolicy->remove(task);
+    timerWheel.cancel(task);
+    countdownTasks.erase(remove(countdownTasks.begin(), countdownTasks.end(), task), countdownTasks.end());
+    taskTable.erase(task->getId());
+}
+
 void Scheduler::getRegistrationStats() const {
     lock_guard<mutex> lock(schedulerMutex);
     
-    int totalTasks = static_cast<int>(registeredTasks.size());
+    int totalTasks = static_cast<int>(taskTable.size());
     int readyTasks = getTaskCountByState(TaskState::READY);
     int runningTasks = getTaskCountByState(TaskState::RUNNING);
     int waitingTasks = getTaskCountByState(TaskState::WAITING);
@@ -127,50 +200,45 @@ void Scheduler::getRegistrationStats() const {
 
 int Scheduler::getTaskCountByPriority(Priority priority) const {
     int count = 0;
-    for (const auto& pair : registeredTasks) {
-        if (pair.second->getPriority() == priority) {
+    taskTable.forEach([&](const TCB& task) {
+        if (task.getPriority() == priority) {
             count++;
         }
-    }
+    });
     return count;
 }
 
 bool Scheduler::hasTaskWithPriority(Priority priority) const {
     lock_guard<mutex> lock(schedulerMutex);
-    for (const auto& pair : registeredTasks) {
-        if (pair.second->getPriority() == priority) {
-            return true;
-        }
-    }
-    return false;
+    return getTaskCountByPriority(priority) > 0;
 }
 
 vector<string> Scheduler::getTaskNamesByState(TaskState state) const {
     lock_guard<mutex> lock(schedulerMutex);
     vector<string> taskNames;
     
-    for (const auto& pair : registeredTasks) {
-        if (pair.second->getState() == state) {
-            taskNames.push_back(pair.first);
+    taskTable.forEach([&](const TCB& task) {
+        if (task.getState() == state) {
+            taskNames.push_back(task.getName());
         }
-    }
+    });
     return taskNames;
 }
 
 int Scheduler::getTaskCountByState(TaskState state) const {
     int count = 0;
-    for (const auto& pair : registeredTasks) {
-        if (pair.second->getState() == state) {
+    taskTable.forEach([&](const TCB& task) {
+        if (task.getState() == state) {
             count++;
         }
-    }
+    });
     return count;
 }
 
 void Scheduler::displayTaskSummary() const {
     lock_guard<mutex> lock(schedulerMutex);
     
-    if (registeredTasks.empty()) {
+    if (taskTable.empty()) {
         Kernel::getInstance().getLogger().log(MessageType::INFO, "No tasks to summarize");
         return;
     }
@@ -180,13 +248,13 @@ void Scheduler::displayTaskSummary() const {
     // HIGH Priority Tasks
     Kernel::getInstance().getLogger().log(MessageType::INFO, "HIGH Priority Tasks:");
     bool foundHigh = false;
-    for (const auto& pair : registeredTasks) {
-        if (pair.second->getPriority() == Priority::HIGH) {
+    taskTable.forEach([&](const TCB& task) {
+        if (task.getPriority() == Priority::HIGH) {
             Kernel::getInstance().getLogger().log(MessageType::INFO, 
-                "  - " + pair.first + " (" + pair.second->getStateString() + ")");
+                "  - " + task.getName() + " (" + task.getStateString() + ")");
             foundHigh = true;
         }
-    }
+    });
     if (!foundHigh) {
         Kernel::getInstance().getLogger().log(MessageType::INFO, "  (none)");
     }
@@ -194,13 +262,13 @@ void Scheduler::displayTaskSummary() const {
     // MEDIUM Priority Tasks
     Kernel::getInstance().getLogger().log(MessageType::INFO, "MEDIUM Priority Tasks:");
     bool foundMedium = false;
-    for (const auto& pair : registeredTasks) {
-        if (pair.second->getPriority() == Priority::MEDIUM) {
+    taskTable.forEach([&](const TCB& task) {
+        if (task.getPriority() == Priority::MEDIUM) {
             Kernel::getInstance().getLogger().log(MessageType::INFO, 
-                "  - " + pair.first + " (" + pair.second->getStateString() + ")");
+                "  - " + task.getName() + " (" + task.getStateString() + ")");
             foundMedium = true;
         }
-    }
+    });
     if (!foundMedium) {
         Kernel::getInstance().getLogger().log(MessageType::INFO, "  (none)");
     }
@@ -208,139 +276,489 @@ void Scheduler::displayTaskSummary() const {
     // LOW Priority Tasks
     Kernel::getInstance().getLogger().log(MessageType::INFO, "LOW Priority Tasks:");
     bool foundLow = false;
-    for (const auto& pair : registeredTasks) {
-        if (pair.second->getPriority() == Priority::LOW) {
+    taskTable.forEach([&](const TCB& task) {
+        if (task.getPriority() == Priority::LOW) {
             Kernel::getInstance().getLogger().log(MessageType::INFO, 
-                "  - " + pair.first + " (" + pair.second->getStateString() + ")");
+                "  - " + task.getName() + " (" + task.getStateString() + ")");
             foundLow = true;
         }
-    }
+    });
     if (!foundLow) {
         Kernel::getInstance().getLogger().log(MessageType::INFO, "  (none)");
     }
 }
 
 //round-robin, prioirty based execution logic
+//ready tasks are ordered by schedulingPolicy (PRIORITY by default: highest level first, FIFO inside a level)
+
+void Scheduler::makeTaskReady(TCB* task){
+    task->release(timerWheel.getCurrentTick());
+    schedulingPolicy->enqueue(task);
+}
 
 vector<string> Scheduler::getReadyTasksInOrder() const {
     vector<string> readyTasks;
+    for (const TCB* task : schedulingPolicy->snapshot()) {
+        readyTasks.push_back(task->getName());
+    }
+    return readyTasks;
+}
+
+//callbacks run without schedulerMutex, the lock only covers dequeue and state transitions
+
+TCB* Scheduler::startNextReadyTask(){
+    TCB* task = schedulingPolicy->dequeue();
+    if(!task){
+        return nullptr;
+    }
     
-    for (const auto& pair : registeredTasks) {
-        if (pair.second->getState() == TaskState::READY) {
-            readyTasks.push_back(pair.first);
+    VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::SCHEDULER, "Executing {} (READY -> RUNNING)", task->getName());
+    
+    if(!task->setState(TaskState::RUNNING)){
+        Kernel::getInstance().getLogger().log(MessageType::ERRORS, "Failed to transition " + task->getName() + " to RUNNING state");
+        return nullptr;
+    }
+    return task;
+}
+
+bool Scheduler::executeNextReadyTask(){
+    TCB* task = nullptr;
+    {
+        lock_guard<mutex> lock(schedulerMutex);
+        if(schedulingPolicy->empty()){
+            VOS_LOG_RATE_LIMITED(Kernel::getInstance().getLogger(), MessageType::SCHEDULER, "No READY tasks available for execution");
+            return false;
+        }
+        if (workerPool) {
+            return dispatchToWorkers();
+        }
+        task = startNextReadyTask();
+        if (!task) {
+            return false;
+        }
+    }
+    return runTask(task);
+}
+
+//hands every READY task to the per-worker run queues, idle workers steal to balance them
+bool Scheduler::dispatchToWorkers(){
+    unsigned dispatched = 0;
+    while (!schedulingPolicy->empty()) {
+        TCB* task = startNextReadyTask();
+        if (!task) {
+            break;
         }
+        if (!workerPool->submit(task)) {
+            task->setState(TaskState::READY);
+            schedulingPolicy->enqueue(task);
+            break;
+        }
+        dispatched++;
+    }
+    return dispatched > 0;
+}
+
+bool Scheduler::runTask(TCB* task){
+    task->recordRunStart();
+    auto startTime = chrono::steady_clock::now();
+    bool executionSuccess = task->executeTask();
+    auto executionTime = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - startTime);
+    completeTask(task, executionSuccess, executionTime);
+    return executionSuccess;
+}
+
+void Scheduler::completeTask(TCB* task, bool executionSuccess, chrono::microseconds executionTime){
+    lock_guard<mutex> lock(schedulerMutex);
+    string taskName = task->getName();
+    task->recordExecutionTime(executionTime);
+
+    if(executionSuccess){
+        VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::SCHEDULER, "{} completed successfully", taskName);
+    } else {
+        Kernel::getInstance().getLogger().log(MessageType::ERRORS,  taskName + " execution failed");
+    }
+
+    int lateness = task->recordCompletion(timerWheel.getCurrentTick());
+    if (lateness > 0) {
+        VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::SCHEDULER, "{} missed its deadline by {} ticks", taskName, lateness);
+    }
+
+    if (task->isRemovalPending()) {
+        releaseTask(task);
+        Kernel::getInstance().getLogger().log(MessageType::INFO, "Task unregistered: " + taskName);
+        return;
     }
     
-    // sorting based on priority
-    sort(readyTasks.begin(), readyTasks.end(), [this] (const string& a, const string& b){
-        auto taskA = registeredTasks.at(a).get();
-        auto taskB = registeredTasks.at(b).get();
-        return static_cast<int>(taskA->getPriority()) > static_cast<int>(taskB->getPriority());
-    }  );
-    return readyTasks;
+    if(!task->setState(TaskState::WAITING)){
+        Kernel::getInstance().getLogger().log(MessageType::ERRORS, "Failed to transition " + taskName + " to WAITING state");
+    } else {
+        armTaskTimer(task);
+        VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::SCHEDULER, "{} complete (RUNNING -> WAITING)", taskName);
+    }
 }
 
-string Scheduler::getNextTaskToExecute(vector<string> taskReady) const {
-    if (taskReady.empty()) {
-        return "";
+bool Scheduler::enableParallelExecution(unsigned workerCount){
+    lock_guard<mutex> lock(schedulerMutex);
+    if (workerPool) {
+        return false;
     }
-    if (lastExecutedTask.empty()) {
-        return taskReady[0];
+    if (workerCount == 0) {
+        workerCount = max(1u, thread::hardware_concurrency());
     }
-    auto it = find(taskReady.begin(), taskReady.end(), lastExecutedTask);
-    if (it == taskReady.end()) {
-        return taskReady[0];
+    workerPool = make_unique<WorkerPool>(workerCount, [this](TCB* task, unsigned){
+        runTask(task);
+    });
+    VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::SCHEDULER, "Parallel execution enabled with {} workers", workerCount);
+    return true;
+}
+
+void Scheduler::disableParallelExecution(){
+    unique_ptr<WorkerPool> pool;
+    {
+        lock_guard<mutex> lock(schedulerMutex);
+        pool = std::move(workerPool);
     }
-    auto nextTask = next(it);
-    if (nextTask == taskReady.end()) {
-        return taskReady[0];
+    //workers take schedulerMutex to complete their tasks, so join without holding it
+    if (pool) {
+        pool->stop();
     }
-    return *nextTask;
 }
-bool Scheduler::executeNextReadyTask(){
+
+bool Scheduler::isParallelExecutionEnabled() const {
     lock_guard<mutex> lock(schedulerMutex);
-    
-    vector<string> readyTasks = getReadyTasksInOrder();
-    if(readyTasks.empty()){
-        Kernel::getInstance().getLogger().log(MessageType::SCHEDULER, "No READY tasks available for execution");
+    return workerPool != nullptr;
+}
+
+unsigned Scheduler::getWorkerCount() const {
+    lock_guard<mutex> lock(schedulerMutex);
+    return workerPool ? workerPool->getWorkerCount() : 0;
+}
+
+bool Scheduler::setSchedulingPolicy(unique_ptr<SchedulingPolicy> policy){
+    if (!policy) {
         return false;
     }
-    
-    string taskToExecute = getNextTaskToExecute(readyTasks);
-    
-    auto it = registeredTasks.find(taskToExecute);
-    if(it == registeredTasks.end()){
+    lock_guard<mutex> lock(schedulerMutex);
+    for (TCB* task : schedulingPolicy->snapshot()) {
+        schedulingPolicy->remove(task);
+        policy->enqueue(task);
+    }
+    schedulingPolicy = std::move(policy);
+    VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::SCHEDULER, "Scheduling policy set to {}", schedulingPolicy->getName());
+    return true;
+}
+
+string Scheduler::getSchedulingPolicyName() const {
+    lock_guard<mutex> lock(schedulerMutex);
+    return schedulingPolicy->getName();
+}
+
+bool Scheduler::setTaskDeadline(const string& taskName, int relativeDeadlineTicks){
+    lock_guard<mutex> lock(schedulerMutex);
+    TCB* task = taskTable.findByName(taskName);
+    if (!task || !task->setRelativeDeadline(relativeDeadlineTicks)) {
         return false;
     }
-    
-    TCB* task = it->second.get();
-    
-    Kernel::getInstance().getLogger().log(MessageType::SCHEDULER, "Executing " + taskToExecute + " (READY -> RUNNING)");
-    
-    if(!task->setState(TaskState::RUNNING)){
-        Kernel::getInstance().getLogger().log(MessageType::ERRORS, "Failed to transition " + taskToExecute + " to RUNNING state");
+    VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::SCHEDULER, "{} relative deadline set to {} ticks",
+             taskName, task->getEffectiveRelativeDeadline());
+    return true;
+}
+
+void Scheduler::displayDeadlineStatistics() const {
+    lock_guard<mutex> lock(schedulerMutex);
+    Kernel::getInstance().getLogger().log(MessageType::HEADER, "Deadline Statistics (" + schedulingPolicy->getName() + ")");
+    int totalMisses = 0;
+    taskTable.forEach([&](const TCB& task) {
+        Kernel::getInstance().getLogger().log(MessageType::STATUS, task.getName() + ": deadline " +
+                                                to_string(task.getEffectiveRelativeDeadline()) + " ticks, " +
+                                                to_string(task.getDeadlineMisses()) + " misses, worst lateness " +
+                                                to_string(task.getWorstLateness()) + " ticks");
+        totalMisses += task.getDeadlineMisses();
+    });
+    Kernel::getInstance().getLogger().log(MessageType::STATUS, "Total deadline misses: " + to_string(totalMisses));
+}
+
+bool Scheduler::setTaskAffinity(const string& taskName, uint64_t workerMask){
+    lock_guard<mutex> lock(schedulerMutex);
+    TCB* task = taskTable.findByName(taskName);
+    if (!task) {
         return false;
     }
-    
-    bool executionSuccess = task->executeTask();
-    
-    if(executionSuccess){
-        Kernel::getInstance().getLogger().log(MessageType::SCHEDULER,  taskToExecute + " completed successfully");
-    } else {
-        Kernel::getInstance().getLogger().log(MessageType::ERRORS,  taskToExecute + " execution failed");
+    task->setAffinityMask(workerMask);
+    VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::SCHEDULER, "{} affinity mask set to {}", taskName, workerMask);
+    return true;
+}
+
+
+//command queue: producers never touch schedulerMutex, the clock thread applies
+//everything queued before it starts a tick, taking the lock once per drain
+
+future<bool> Scheduler::enqueueCommand(SchedulerCommand command){
+    future<bool> result = command.result.get_future();
+    pendingCommands.push(std::move(command));
+    return result;
+}
+
+future<bool> Scheduler::submitRegisterTask(unique_ptr<TCB> task, CommandCallback onComplete){
+    SchedulerCommand command;
+    command.type = SchedulerCommandType::REGISTER_TASK;
+    command.task = std::move(task);
+    command.onComplete = std::move(onComplete);
+    return enqueueCommand(std::move(command));
+}
+
+future<bool> Scheduler::submitUnregisterTask(const string& name, CommandCallback onComplete){
+    SchedulerCommand command;
+    command.type = SchedulerCommandType::UNREGISTER_TASK;
+    command.taskName = name;
+    command.onComplete = std::move(onComplete);
+    return enqueueCommand(std::move(command));
+}
+
+future<bool> Scheduler::submitAdjustTaskTimer(const string& taskName, int newPeriod, CommandCallback onComplete){
+    SchedulerCommand command;
+    command.type = SchedulerCommandType::ADJUST_PERIOD;
+    command.taskName = taskName;
+    command.period = newPeriod;
+    command.onComplete = std::move(onComplete);
+    return enqueueCommand(std::move(command));
+}
+
+future<bool> Scheduler::submitPauseTaskTimer(const string& taskName, CommandCallback onComplete){
+    SchedulerCommand command;
+    command.type = SchedulerCommandType::PAUSE_TIMER;
+    command.taskName = taskName;
+    command.onComplete = std::move(onComplete);
+    return enqueueCommand(std::move(command));
+}
+
+future<bool> Scheduler::submitResumeTaskTimer(const string& taskName, CommandCallback onComplete){
+    SchedulerCommand command;
+    command.type = SchedulerCommandType::RESUME_TIMER;
+    command.taskName = taskName;
+    command.onComplete = std::move(onComplete);
+    return enqueueCommand(std::move(command));
+}
+
+//caller holds schedulerMutex
+bool Scheduler::applyCommand(SchedulerCommand& command){
+    switch (command.type) {
+        case SchedulerCommandType::REGISTER_TASK:
+            return registerTaskLocked(std::move(command.task));
+        case SchedulerCommandType::UNREGISTER_TASK:
+            return unregisterTaskLocked(command.taskName);
+        case SchedulerCommandType::ADJUST_PERIOD:
+            return adjustTaskTimerLocked(command.taskName, command.period);
+        case SchedulerCommandType::PAUSE_TIMER:
+            return pauseTaskTimerLocked(command.taskName);
+        case SchedulerCommandType::RESUME_TIMER:
+            return resumeTaskTimerLocked(command.taskName);
     }
-    
-    if(!task->setState(TaskState::WAITING)){
-        Kernel::getInstance().getLogger().log(MessageType::ERRORS, "Failed to transition " + taskToExecute + " to WAITING state");
-    } else {
-        Kernel::getInstance().getLogger().log(MessageType::SCHEDULER,  taskToExecute + " complete (RUNNING -> WAITING)");
+    return false;
+}
+
+//the whole drain is applied under one schedulerMutex acquisition; results are reported after it is
+//released so futures and callbacks can call straight back into the scheduler
+size_t Scheduler::processPendingCommands(){
+    SchedulerCommand command;
+    if (!pendingCommands.pop(command)) {
+        return 0;
+    }
+    vector<pair<SchedulerCommand, bool>> applied;
+    {
+        lock_guard<mutex> lock(schedulerMutex);
+        do {
+            bool success = applyCommand(command);
+            applied.emplace_back(std::move(command), success);
+        } while (pendingCommands.pop(command));
+    }
+    for (auto& entry : applied) {
+        entry.first.result.set_value(entry.second);
+        if (entry.first.onComplete) {
+            try {
+                entry.first.onComplete(entry.second);
+            } catch (const exception& e) {
+                Kernel::getInstance().getLogger().log(MessageType::ERRORS, 
+                    string("Scheduler command callback threw: ") + e.what());
+            }
+        }
     }
-    
-    lastExecutedTask = taskToExecute;
-    return executionSuccess;
+    return applied.size();
+}
+
+void Scheduler::queueBottomHalf(function<void()> work){
+    if (bottomHalfStopping.load(memory_order_acquire)) {
+        return;
+    }
+    //queued before startBottomHalves() the work simply waits for the thread
+    bottomHalves.push(BottomHalf{std::move(work), chrono::steady_clock::now()});
+    pendingBottomHalves.fetch_add(1);
+    //the mutex is only touched when the thread is (about to be) asleep
+    if (bottomHalfSleeping.load()) {
+        lock_guard<mutex> lock(bottomHalfMutex);
+        bottomHalfCondition.notify_one();
+    }
+}
+
+void Scheduler::startBottomHalves(){
+    lock_guard<mutex> lock(bottomHalfMutex);
+    if (bottomHalfStarted.load(memory_order_relaxed) || bottomHalfStopping.load(memory_order_relaxed)) {
+        return;
+    }
+    bottomHalfThread = thread(&Scheduler::bottomHalfLoop, this);
+    bottomHalfStarted.store(true, memory_order_release);
 }
 
+void Scheduler::bottomHalfLoop(){
+    for (;;) {
+        runBottomHalves();
+        unique_lock<mutex> lock(bottomHalfMutex);
+        bottomHalfSleeping.store(true);
+        bottomHalfCondition.wait(lock, [this]{
+            return pendingBottomHalves.load() > 0 || bottomHalfStopping.load();
+        });
+        bottomHalfSleeping.store(false);
+        if (bottomHalfStopping.load() && pendingBottomHalves.load() == 0) {
+            return;
+        }
+    }
+}
 
-void Scheduler::updateTaskTimers() {
+//bottom-half thread only (or after it has been joined), the queue has a single consumer
+void Scheduler::runBottomHalves(){
+    BottomHalf bottomHalf;
+    while (pendingBottomHalves.load() > 0) {
+        //a producer between its two push steps, the entry shows up on the next pop
+        if (!bottomHalves.pop(bottomHalf)) {
+            this_thread::yield();
+            continue;
+        }
+        pendingBottomHalves.fetch_sub(1);
+        bottomHalfLatency.record(static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - bottomHalf.queuedAt).count()));
+        try {
+            bottomHalf.work();
+        } catch (const exception& e) {
+            Kernel::getInstance().getLogger().log(MessageType::ERRORS, 
+                string("Bottom half threw: ") + e.what());
+        }
+        bottomHalfCount.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void Scheduler::stopBottomHalves(){
+    {
+        lock_guard<mutex> lock(bottomHalfMutex);
+        if (bottomHalfStopping.exchange(true)) {
+            return;
+        }
+        bottomHalfCondition.notify_one();
+    }
+    if (bottomHalfThread.joinable()) {
+        bottomHalfThread.join();
+    }
+}
+
+//wait timers live in timerWheel keyed on the absolute expiry tick,
+//only the tasks whose timer fires this tick are touched
+
+void Scheduler::armTaskTimer(TCB* task){
+    if (task->isTimerPaused()) {
+        task->setPausedRemainingTicks(task->getEffectiveWaitTicks());
+        return;
+    }
+    timerWheel.schedule(task, timerWheel.getCurrentTick() + task->getEffectiveWaitTicks());
+}
+
+int Scheduler::getRemainingWaitTicks(const TCB* task) const {
+    if (timerWheel.isArmed(task)) {
+        return static_cast<int>(task->getExpiryTick() - timerWheel.getCurrentTick());
+    }
+    if (task->isTimerPaused()) {
+        return task->getPausedRemainingTicks();
+    }
+    return 0;
+}
+
+void Scheduler::updateTaskTimers(int elapsedTicks) {
     lock_guard<mutex> lock(schedulerMutex);
+    auto startTime = chrono::steady_clock::now();
     
-    for(auto& pair : registeredTasks) {
-        if(pair.second->getState() == TaskState::WAITING) {
-            if(pair.second->isCountDownLoggingEnabled()) {
-                int remaining = pair.second->getWaitTicks() - pair.second->getCurrentWaitTicks();
-                Kernel::getInstance().getLogger().log(MessageType::TIMER, 
-                     pair.first + " countdown: " + to_string(remaining) + " ticks remaining");
-            }
-            
-            if(pair.second->incrementCurrentWaitTimer()) {
-                Kernel::getInstance().getLogger().log(MessageType::TIMER, 
-                     pair.first + " timer expired (WAITING -> READY)");
+    for(TCB* task : countdownTasks) {
+        if(task->getState() == TaskState::WAITING && timerWheel.isArmed(task)) {
+            VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::TIMER, "{} countdown: {} ticks remaining",
+                     task->getName(), getRemainingWaitTicks(task));
+        }
+    }
+
+    for (int step = 0; step < elapsedTicks; step++) {
+        TCB* task = timerWheel.advance();
+        while (task) {
+            TCB* next = TimerWheel::nextExpired(task);
+            if(task->expireWaitTimer()) {
+                task->incrementActivation();
+                makeTaskReady(task);
+                VOS_LOGF(Kernel::getInstance().getLogger(), MessageType::TIMER, "{} timer expired (WAITING -> READY)", task->getName());
             }
+            task = next;
         }
     }
+
+    totalTimerMicroseconds += static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - startTime).count());
+    timerUpdateCount++;
+    timerOverheadMicroseconds = static_cast<int>(totalTimerMicroseconds / timerUpdateCount);
 }
 
 //statictics
 
+static string formatPercentiles(const LatencyHistogram::Snapshot& histogram){
+    return to_string(histogram.percentile(50.0)) + "/" +
+           to_string(histogram.percentile(99.0)) + "/" +
+           to_string(histogram.percentile(99.9)) + "/" +
+           to_string(histogram.maxValue) + "us";
+}
+
 void Scheduler::displayTimerStatistics() const{
     lock_guard<mutex> lock(schedulerMutex);
     Kernel::getInstance().getLogger().log(MessageType::HEADER, "Timer System Statistics");
     int totalActivations = 0;
     float totalAvgWait = 0.0f;
-    for (const auto& pair : registeredTasks) {
-        int activations = pair.second->getTimerActivations();
-        float avgWait = pair.second->getAvgWaitTime();
+    taskTable.forEach([&](const TCB& task) {
+        int activations = task.getTimerActivations();
+        float avgWait = task.getAvgWaitTime();
 
-        Kernel::getInstance().getLogger().log(MessageType::STATUS, pair.first+": "+
+        Kernel::getInstance().getLogger().log(MessageType::STATUS, task.getName()+": "+
                                                 to_string(activations) + " activations," +
                                             "avg wait: "+to_string(avgWait) + "ms");
         totalActivations+=activations;
         totalAvgWait+=avgWait;
-    }
+
+        TaskLatencySnapshot latency = task.getLatencySnapshot();
+        if (latency.runTime.totalCount == 0 && latency.wakeLatency.totalCount == 0) {
+            return;
+        }
+        bool overBudget = latency.runTime.maxValue > static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(Clock::TICK_INTERVALS).count());
+        Kernel::getInstance().getLogger().log(MessageType::STATUS, "  p50/p99/p999/max run: " + formatPercentiles(latency.runTime) +
+                                                ", wake: " + formatPercentiles(latency.wakeLatency) +
+                                                ", jitter: " + formatPercentiles(latency.periodJitter) +
+                                                (overBudget ? " [EXCEEDS TICK BUDGET]" : ""));
+    });
     Kernel::getInstance().getLogger().log(MessageType::STATUS, 
         "Total activations: " + to_string(totalActivations));
     Kernel::getInstance().getLogger().log(MessageType::STATUS, 
-        "System average wait: " + to_string(totalAvgWait / registeredTasks.size()) + "ms");
+        "System average wait: " + to_string(totalAvgWait / taskTable.size()) + "ms");
+
+    if (workerPool) {
+        for (const WorkerStats& worker : workerPool->getWorkerStats()) {
+            Kernel::getInstance().getLogger().log(MessageType::STATUS, 
+                "Worker " + to_string(worker.workerIndex) + ": " +
+                to_string(worker.tasksExecuted) + " executed, " +
+                to_string(worker.steals) + " steals, " +
+                to_string(worker.failedSteals) + " failed steals, " +
+                to_string(worker.idleWaits) + " idle waits, " +
+                to_string(worker.queuedTasks) + " queued");
+        }
+    }
 }
 
 pair<string, int> Scheduler::getMostActiveTask() const{
@@ -348,26 +766,55 @@ pair<string, int> Scheduler::getMostActiveTask() const{
 
     string mostActive = "";
     int maxActivations = 0;
-    for (const auto& pair : registeredTasks) {
-        int activation = pair.second->getTimerActivations();
+    taskTable.forEach([&](const TCB& task) {
+        int activation = task.getTimerActivations();
         if(activation>maxActivations){
-            mostActive = pair.first;
+            mostActive = task.getName();
             maxActivations = activation;
         }
-    }
+    });
     return make_pair(mostActive, maxActivations);
 }
 
 bool Scheduler::adjustTaskTimer(const string& taskName, int newPeriod){
     lock_guard<mutex> lock(schedulerMutex);
+    return adjustTaskTimerLocked(taskName, newPeriod);
+}
 
+bool Scheduler::adjustTaskTimerLocked(const string& taskName, int newPeriod){
     if (newPeriod<=0) {
         Kernel::getInstance().getLogger().log(MessageType::ERRORS, "Invalid period " + to_string(newPeriod) + " for " + taskName);
         return false;
     }
-    auto it = registeredTasks.find(taskName);
-    if (it!=registeredTasks.end()) {
-        it->second->setWaitTicks(newPeriod);
+    TCB* task = taskTable.findByName(taskName);
+    if (task) {
+        //keep the ticks already waited and apply them to the new period
+        int elapsed = task->getEffectiveWaitTicks() - getRemainingWaitTicks(task);
+        int remaining = max(newPeriod - elapsed, 1);
+        //the period can be the policy's ordering key, so a queued task comes out while it changes
+        //and the new period has to pass admission like a new task would
+        int oldPeriod = task->getWaitTicks();
+        bool queued = schedulingPolicy->remove(task);
+        task->setWaitTicks(newPeriod);
+        string rejectionReason;
+        if (!admitTask(*task, rejectionReason)) {
+            task->setWaitTicks(oldPeriod);
+            if (queued) {
+                schedulingPolicy->enqueue(task);
+            }
+            Kernel::getInstance().getLogger().log(MessageType::ERRORS, 
+                "Period change rejected by " + schedulingPolicy->getName() + " for " + taskName + ": " + rejectionReason);
+            return false;
+        }
+        if (queued) {
+            schedulingPolicy->enqueue(task);
+        }
+        if (timerWheel.isArmed(task)) {
+            timerWheel.schedule(task, timerWheel.getCurrentTick() + remaining);
+        }
+        else if (task->isTimerPaused() && task->getState() == TaskState::WAITING) {
+            task->setPausedRemainingTicks(remaining);
+        }
         Kernel::getInstance().getLogger().log(MessageType::TIMER, 
             taskName + " period adjusted to " + to_string(newPeriod) + " ticks");
         return true;
@@ -377,9 +824,17 @@ bool Scheduler::adjustTaskTimer(const string& taskName, int newPeriod){
 
 bool Scheduler::pauseTaskTimer(const string& taskName){
     lock_guard<mutex> lock(schedulerMutex);
-    auto it = registeredTasks.find(taskName);
-    if (it!= registeredTasks.end()) {
-        it->second->pauseTimer();
+    return pauseTaskTimerLocked(taskName);
+}
+
+bool Scheduler::pauseTaskTimerLocked(const string& taskName){
+    TCB* task = taskTable.findByName(taskName);
+    if (task) {
+        if (!task->isTimerPaused() && timerWheel.isArmed(task)) {
+            task->setPausedRemainingTicks(getRemainingWaitTicks(task));
+            timerWheel.cancel(task);
+        }
+        task->pauseTimer();
         Kernel::getInstance().getLogger().log(MessageType::TIMER, 
              taskName + " timer paused");
         return true;
@@ -389,9 +844,16 @@ bool Scheduler::pauseTaskTimer(const string& taskName){
 
 bool Scheduler::resumeTaskTimer(const string& taskName){
     lock_guard<mutex> lock(schedulerMutex);
-    auto it = registeredTasks.find(taskName);
-    if (it!=registeredTasks.end()) {
-        it->second->resumeTimer();
+    return resumeTaskTimerLocked(taskName);
+}
+
+bool Scheduler::resumeTaskTimerLocked(const string& taskName){
+    TCB* task = taskTable.findByName(taskName);
+    if (task) {
+        if (task->isTimerPaused() && task->getState() == TaskState::WAITING) {
+            timerWheel.schedule(task, timerWheel.getCurrentTick() + task->getPausedRemainingTicks());
+        }
+        task->resumeTimer();
         Kernel::getInstance().getLogger().log(MessageType::TIMER, 
              taskName + " timer resumed");
         return true;
@@ -402,14 +864,32 @@ bool Scheduler::resumeTaskTimer(const string& taskName){
 vector<pair<string, pair<int, int>>> Scheduler::getTimerStatus() const{ //name, (current, total)
     lock_guard<mutex> lock(schedulerMutex);
     vector<pair<string, pair<int, int>>> status;
-    for (const auto& pair: registeredTasks) {
-        if (pair.second->getState() == TaskState::WAITING) {
-            status.emplace_back(pair.first, make_pair(pair.second->getCurrentWaitTicks(),pair.second->getWaitTicks()));
+    taskTable.forEach([&](const TCB& task) {
+        if (task.getState() == TaskState::WAITING) {
+            int total = task.getEffectiveWaitTicks();
+            status.emplace_back(task.getName(), make_pair(total - getRemainingWaitTicks(&task), total));
         }
-    }
+    });
     return status;
 }
 
+bool Scheduler::setTaskCountdownLogging(const string& taskName, bool enable){
+    lock_guard<mutex> lock(schedulerMutex);
+    TCB* task = taskTable.findByName(taskName);
+    if (!task) {
+        return false;
+    }
+    task->enableTimerCountdown(enable);
+    auto pos = find(countdownTasks.begin(), countdownTasks.end(), task);
+    if (enable && pos == countdownTasks.end()) {
+        countdownTasks.push_back(task);
+    }
+    else if (!enable && pos != countdownTasks.end()) {
+        countdownTasks.erase(pos);
+    }
+    return true;
+}
+
 bool Scheduler::validateTimerValue(const unique_ptr<TCB>& task) const {
     if (task->getWaitTicks() < 0 || task->getWaitTicks()>MAX_TIMER_VALUE) {
         Kernel::getInstance().getLogger().log(MessageType::ERRORS, "Wait time is either too large or negative");
@@ -423,26 +903,26 @@ void Scheduler::displayDetailedTimerStatus() const {
     
     Kernel::getInstance().getLogger().log(MessageType::HEADER, "Detailed Timer Status");
     
-    for(const auto& pair : registeredTasks) {
-        const auto& task = pair.second;
+    taskTable.forEach([&](const TCB& task) {
         string status;
         
-        if(task->getState() == TaskState::WAITING) {
-            int remaining = task->getWaitTicks() - task->getCurrentWaitTicks();
-            float progress = static_cast<float>(task->getCurrentWaitTicks()) / task->getWaitTicks() * 100.0f;
+        if(task.getState() == TaskState::WAITING) {
+            int total = task.getEffectiveWaitTicks();
+            int remaining = getRemainingWaitTicks(&task);
+            float progress = static_cast<float>(total - remaining) / total * 100.0f;
             
-            status = task->getStateString() + " (" + to_string(remaining) + "/" + 
-                    to_string(task->getWaitTicks()) + " ticks, " + 
+            status = task.getStateString() + " (" + to_string(remaining) + "/" + 
+                    to_string(total) + " ticks, " + 
                     to_string(static_cast<int>(progress)) + "% complete)";
         } else {
-            status = task->getStateString();
+            status = task.getStateString();
         }
         
         Kernel::getInstance().getLogger().log(MessageType::STATUS, 
-            pair.first + ": " + status + 
-            " - Activations: " + to_string(task->getTimerActivations()) +
-            (task->isTimerPaused() ? " [PAUSED]" : ""));
-    }
+            task.getName() + ": " + status + 
+            " - Activations: " + to_string(task.getTimerActivations()) +
+            (task.isTimerPaused() ? " [PAUSED]" : ""));
+    });
     
     auto mostActive = getMostActiveTask();
     Kernel::getInstance().getLogger().log(MessageType::STATUS, 
@@ -454,7 +934,7 @@ void Scheduler::displayTimerEfficiency() const {
     
     Kernel::getInstance().getLogger().log(MessageType::HEADER, "Timer System Efficiency");
     
-    int totalTasks = static_cast<int>(registeredTasks.size());
+    int totalTasks = static_cast<int>(taskTable.size());
     int waitingTasks = getTaskCountByState(TaskState::WAITING);
     int readyTasks = getTaskCountByState(TaskState::READY);
     
@@ -1,27 +1,99 @@
 #pragma once
-#include <unordered_map>
 #include "TCB.h"
+#include "TaskTable.h"
 #include "TaskTypes.h"
+#include "SchedulingPolicy.h"
+#include "TimerWheel.h"
+#include "WorkerPool.h"
+#include "MpscQueue.h"
+#include "SchedulerCommand.h"
+#include "LatencyHistogram.h"
+#include<atomic>
+#include<condition_variable>
+#include<functional>
 #include<string>
+#include<thread>
 #include<memory>
 #include<mutex>
 #include <utility>
 #include <vector>
+#include <chrono>
+#include <future>
 
 using namespace std;
 
 class Scheduler{
     private:
-        unordered_map<string, unique_ptr<TCB>> registeredTasks;
+        TaskTable taskTable;
+        unique_ptr<SchedulingPolicy> schedulingPolicy;
+        TimerWheel timerWheel;
+        vector<TCB*> countdownTasks;
         mutable mutex schedulerMutex;
-        string lastExecutedTask;
+        //average cost of updateTaskTimers over all ticks so far
         mutable int timerOverheadMicroseconds;
+        uint64_t totalTimerMicroseconds;
+        uint64_t timerUpdateCount;
         static constexpr int MAX_TIMER_VALUE = 1000;
+
+        //filled by any thread without taking schedulerMutex, drained by the clock thread
+        MpscQueue<SchedulerCommand> pendingCommands;
+
+        //deferred interrupt work, filled lock-free from the ISR thread and run in order on the
+        //bottom-half thread as soon as it is queued instead of waiting for the next tick
+        struct BottomHalf{
+            function<void()> work;
+            chrono::steady_clock::time_point queuedAt;
+        };
+        MpscQueue<BottomHalf> bottomHalves;
+        atomic<size_t> pendingBottomHalves;
+        mutex bottomHalfMutex;
+        condition_variable bottomHalfCondition;
+        atomic<bool> bottomHalfSleeping;
+        atomic<bool> bottomHalfStarted;
+        atomic<bool> bottomHalfStopping;
+        thread bottomHalfThread;
+        atomic<uint64_t> bottomHalfCount;
+        //queue to start, us
+        LatencyHistogram bottomHalfLatency;
+
+        //declared last so the workers are joined before the task storage goes away
+        unique_ptr<WorkerPool> workerPool;
+
+        void bottomHalfLoop();
+        void runBottomHalves();
+
+        void armTaskTimer(TCB* task);
+        int getRemainingWaitTicks(const TCB* task) const;
+        void releaseTask(TCB* task);
+        void makeTaskReady(TCB* task);
+        //caller holds schedulerMutex; checks candidate against every other registered task
+        bool admitTask(const TCB& candidate, string& reason) const;
+
+        TCB* startNextReadyTask();
+        bool dispatchToWorkers();
+        bool runTask(TCB* task);
+        void completeTask(TCB* task, bool executionSuccess, chrono::microseconds executionTime);
+
+        //bodies of the synchronous calls below, caller holds schedulerMutex
+        bool registerTaskLocked(unique_ptr<TCB> task);
+        bool unregisterTaskLocked(const string& name);
+        bool adjustTaskTimerLocked(const string& taskName, int newPeriod);
+        bool pauseTaskTimerLocked(const string& taskName);
+        bool resumeTaskTimerLocked(const string& taskName);
+
+        future<bool> enqueueCommand(SchedulerCommand command);
+        bool applyCommand(SchedulerCommand& command);
     public:
+            Scheduler();
+            ~Scheduler();
+
             bool isValidTask(const unique_ptr<TCB>& task) const;
             bool registerTask(unique_ptr<TCB> task);
             bool isTaskRegistered(const string& name) const;
+            //builds the TCB and registers it in one step, returns the stored TCB or nullptr
+            TCB* createTask(const string& name, Priority priority, function<void()> callback, int waitPeriod = 0);
             TCB* findTaskByName(const string& name) const;
+            TCB* findTaskById(uint32_t taskId) const;
             void getAllRegisteredTasks() const;
             int getNumberOfRegisteredTasks() const;
             bool unregisterTask(const string& name);
@@ -36,9 +108,43 @@ class Scheduler{
 
             vector<string> getReadyTasksInOrder() const;
             bool executeNextReadyTask();
-            string getNextTaskToExecute(vector<string> taskReady) const;
 
-            void updateTaskTimers();
+            //SMP mode: READY tasks are handed to a pool of worker threads, 0 = one per core
+            bool enableParallelExecution(unsigned workerCount = 0);
+            void disableParallelExecution();
+            bool isParallelExecutionEnabled() const;
+            unsigned getWorkerCount() const;
+            bool setTaskAffinity(const string& taskName, uint64_t workerMask);
+
+            //READY tasks move over to the new policy in their current order
+            bool setSchedulingPolicy(unique_ptr<SchedulingPolicy> policy);
+            string getSchedulingPolicyName() const;
+            bool setTaskDeadline(const string& taskName, int relativeDeadlineTicks);
+            void displayDeadlineStatistics() const;
+
+            //non-blocking variants of the calls above, applied at the start of the next tick
+            future<bool> submitRegisterTask(unique_ptr<TCB> task, CommandCallback onComplete = nullptr);
+            future<bool> submitUnregisterTask(const string& name, CommandCallback onComplete = nullptr);
+            future<bool> submitAdjustTaskTimer(const string& taskName, int newPeriod, CommandCallback onComplete = nullptr);
+            future<bool> submitPauseTaskTimer(const string& taskName, CommandCallback onComplete = nullptr);
+            future<bool> submitResumeTaskTimer(const string& taskName, CommandCallback onComplete = nullptr);
+            //clock thread only, returns the number of commands applied
+            size_t processPendingCommands();
+
+            //starts the thread that runs interrupt bottom halves, done by InterruptController::initialise
+            //so the ISR thread never has to
+            void startBottomHalves();
+            //interrupt bottom halves, safe from any thread; never waits for queued work to run, but
+            //allocates a queue node and briefly takes bottomHalfMutex to wake the thread when it is
+            //going to sleep; work queued before startBottomHalves() runs once the thread is up
+            void queueBottomHalf(function<void()> work);
+            //runs whatever is already queued and joins the bottom-half thread, later work is dropped
+            void stopBottomHalves();
+            uint64_t getBottomHalfCount() const {return bottomHalfCount.load(memory_order_relaxed);}
+            LatencyHistogram::Snapshot getBottomHalfLatency() const {return bottomHalfLatency.snapshot();}
+
+            //elapsedTicks > 1 when the clock coalesces missed ticks into one update
+            void updateTaskTimers(int elapsedTicks = 1);
 
             void displayTimerStatistics() const;
             pair<string, int> getMostActiveTask()const;
@@ -49,6 +155,7 @@ class Scheduler{
             bool pauseTaskTimer(const string& taskName);
             bool resumeTaskTimer(const string& taskName);
             vector<pair<string, pair<int, int>>> getTimerStatus() const;
+            bool setTaskCountdownLogging(const string& taskName, bool enable);
 
             bool validateTimerValue(const unique_ptr<TCB>& task) const ;
             void displayDetailedTimerStatus() const;
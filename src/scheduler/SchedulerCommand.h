@@ -0,0 +1,29 @@
+#pragma once
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include "TCB.h"
+
+using namespace std;
+
+enum class SchedulerCommandType{
+    REGISTER_TASK,
+    UNREGISTER_TASK,
+    ADJUST_PERIOD,
+    PAUSE_TIMER,
+    RESUME_TIMER
+};
+
+using CommandCallback = function<void(bool success)>;
+
+//request queued by a producer thread and applied by the clock thread at the start of a tick
+//the result goes to the promise and, if set, to onComplete (called on the clock thread)
+struct SchedulerCommand{
+    SchedulerCommandType type = SchedulerCommandType::REGISTER_TASK;
+    unique_ptr<TCB> task;
+    string taskName;
+    int period = 0;
+    promise<bool> result;
+    CommandCallback onComplete;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class TCB;
+
+//decides which READY task runs next; the scheduler owns one policy at a time
+//and calls it with schedulerMutex held
+class SchedulingPolicy{
+    public:
+        virtual ~SchedulingPolicy() = default;
+
+        virtual string getName() const = 0;
+
+        virtual bool enqueue(TCB* task) = 0;
+        virtual TCB* dequeue() = 0;
+        virtual bool remove(TCB* task) = 0;
+
+        virtual bool empty() const = 0;
+        virtual size_t size() const = 0;
+        //READY tasks in the order they would be dequeued
+        virtual vector<TCB*> snapshot() const = 0;
+
+        //admission control at registerTask, reason explains a rejection
+        virtual bool hasAdmissionControl() const {return false;}
+        virtual bool admit(const TCB& candidate, const vector<const TCB*>& admittedTasks, string& reason) const {
+            (void)candidate; (void)admittedTasks; (void)reason;
+            return true;
+        }
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+using namespace std;
+
+//bounded single-producer/single-consumer ring, Capacity must be a power of two
+template<typename T, size_t Capacity>
+class SpscRing{
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+    private:
+        T slots[Capacity];
+        atomic<size_t> head;
+        atomic<size_t> tail;
+
+    public:
+        SpscRing() : head(0), tail(0){}
+
+        bool push(const T& value){
+            size_t t = tail.load(memory_order_relaxed);
+            if (t - head.load(memory_order_acquire) >= Capacity) {
+                return false;
+            }
+            slots[t & (Capacity - 1)] = value;
+            tail.store(t + 1, memory_order_release);
+            return true;
+        }
+
+        bool pop(T& value){
+            size_t h = head.load(memory_order_relaxed);
+            if (h == tail.load(memory_order_acquire)) {
+                return false;
+            }
+            value = slots[h & (Capacity - 1)];
+            head.store(h + 1, memory_order_release);
+            return true;
+        }
+
+        bool empty() const {
+            return head.load(memory_order_acquire) == tail.load(memory_order_acquire);
+        }
+};
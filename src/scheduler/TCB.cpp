@@ -6,15 +6,48 @@
 
 using namespace std;
 
+TCB::TCB(TCB&& other) noexcept : state(other.state),
+                                 priority(other.priority),
+                                 timerPaused(other.timerPaused),
+                                 removalPending(other.removalPending),
+                                 taskId(other.taskId),
+                                 waitTicks(other.waitTicks),
+                                 pausedRemainingTicks(other.pausedRemainingTicks),
+                                 expiryTick(other.expiryTick),
+                                 readyNext(nullptr),
+                                 readyPrev(nullptr),
+                                 readyLevel(-1),
+                                 timerLevel(-1),
+                                 timerSlot(0),
+                                 timerNext(nullptr),
+                                 timerPrev(nullptr),
+                                 heapIndex(-1),
+                                 heapSequence(0),
+                                 relativeDeadline(other.relativeDeadline),
+                                 releaseTick(other.releaseTick),
+                                 absoluteDeadline(other.absoluteDeadline),
+                                 readySince(other.readySince),
+                                 affinityMask(other.affinityMask),
+                                 lastWorker(other.lastWorker),
+                                 taskName(std::move(other.taskName)),
+                                 taskCallback(std::move(other.taskCallback)),
+                                 enableCountDownLogging(other.enableCountDownLogging),
+                                 timerActivations(other.timerActivations),
+                                 lastActivationTime(other.lastActivationTime),
+                                 totalWaitTIme(other.totalWaitTIme),
+                                 lastActivationInterval(other.lastActivationInterval),
+                                 deadlineMisses(other.deadlineMisses),
+                                 worstLateness(other.worstLateness),
+                                 measuredExecutionTime(other.measuredExecutionTime),
+                                 executionBudget(other.executionBudget),
+                                 latencyStats(std::move(other.latencyStats)) {}
+
 bool TCB::setState(TaskState newState){
     lock_guard<mutex> lock(tcbMutex);
     if(!isValidTransition(state, newState)){
         return false;
     }
     state = newState;
-    if (newState == TaskState::WAITING) {
-        resetWaitTimers();
-    }
     return true;
 }
 
@@ -63,25 +96,51 @@ string TCB::getPriorityString() const {
 }
 
 
-bool TCB::incrementCurrentWaitTimer(){
+bool TCB::expireWaitTimer(){
     lock_guard<mutex> lock(tcbMutex);
     if (state != TaskState::WAITING) {
         return false;
     }
-    currentWaitTicks++;
-    if (currentWaitTicks>=waitTicks) {
-        state = TaskState::READY;
-        currentWaitTicks = 0;
-        return true;
-    }
-    return false;
+    state = TaskState::READY;
+    return true;
 }
 void TCB::incrementActivation(){
     timerActivations++;
     auto now = chrono::steady_clock::now();
 
     if (lastActivationTime != chrono::steady_clock::time_point{}) {
-        totalWaitTIme+=chrono::duration_cast<chrono::milliseconds>(now-lastActivationTime);
+        auto interval = chrono::duration_cast<chrono::microseconds>(now-lastActivationTime);
+        totalWaitTIme+=chrono::duration_cast<chrono::milliseconds>(interval);
+        //jitter = change between consecutive activation intervals
+        if (lastActivationInterval.count() > 0) {
+            auto jitter = interval > lastActivationInterval ? interval - lastActivationInterval : lastActivationInterval - interval;
+            latencyStats->periodJitter.record(static_cast<uint64_t>(jitter.count()));
+        }
+        lastActivationInterval = interval;
     }
     lastActivationTime = now;
+}
+
+void TCB::recordRunStart(){
+    auto latency = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - readySince);
+    latencyStats->wakeLatency.record(static_cast<uint64_t>(latency.count() > 0 ? latency.count() : 0));
+}
+
+TaskLatencySnapshot TCB::getLatencySnapshot() const {
+    TaskLatencySnapshot snapshot;
+    snapshot.runTime = latencyStats->runTime.snapshot();
+    snapshot.wakeLatency = latencyStats->wakeLatency.snapshot();
+    snapshot.periodJitter = latencyStats->periodJitter.snapshot();
+    return snapshot;
+}
+
+int TCB::recordCompletion(uint64_t tick){
+    int lateness = static_cast<int>(static_cast<int64_t>(tick) - static_cast<int64_t>(absoluteDeadline));
+    if (lateness > 0) {
+        deadlineMisses++;
+        if (lateness > worstLateness) {
+            worstLateness = lateness;
+        }
+    }
+    return lateness;
 }
\ No newline at end of file
@@ -2,43 +2,141 @@
 #include <chrono>
 #include <string>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include "LatencyHistogram.h"
 #include "TaskTypes.h"
 #include "TaskManager.h"
 
 using namespace std;
 
+class ReadyQueue;
+class TimerWheel;
+template<typename Compare> class TaskHeap;
+
+//all values in microseconds
+struct TaskLatencyStats{
+    LatencyHistogram runTime;
+    LatencyHistogram wakeLatency;
+    LatencyHistogram periodJitter;
+};
+
+struct TaskLatencySnapshot{
+    LatencyHistogram::Snapshot runTime;
+    LatencyHistogram::Snapshot wakeLatency;
+    LatencyHistogram::Snapshot periodJitter;
+};
+
 class TCB{
+    friend class ReadyQueue;
+    friend class TimerWheel;
+    template<typename Compare> friend class TaskHeap;
     private:
+        //hot per-tick fields first so dispatch/expiry touch as few cache lines as possible
+
         //important tcb parameters
+        TaskState state;
+        Priority priority;
+        bool timerPaused;
+        bool removalPending;
         uint32_t taskId;
+
+        //waitTicks - the number of ticks this task has to wait to execute
+        //expiryTick - absolute scheduler tick at which the wait ends
+        //pausedRemainingTicks - ticks left on the wait when the timer was paused
+        int waitTicks;
+        int pausedRemainingTicks;
+        uint64_t expiryTick;
+
+        //intrusive ready-queue links, owned by ReadyQueue
+        TCB* readyNext;
+        TCB* readyPrev;
+        int readyLevel;
+
+        //intrusive timing-wheel links, owned by TimerWheel
+        int timerLevel;
+        int timerSlot;
+        TCB* timerNext;
+        TCB* timerPrev;
+
+        //intrusive heap slot, owned by TaskHeap
+        int heapIndex;
+        uint64_t heapSequence;
+
+        //relativeDeadline - ticks after release the run must finish by, 0 = the period
+        //absoluteDeadline - scheduler tick the current job is due
+        int relativeDeadline;
+        uint64_t releaseTick;
+        uint64_t absoluteDeadline;
+        //wall time of the last release, wake latency is measured from here
+        chrono::steady_clock::time_point readySince;
+
+        //bit n set = may run on worker n, 0 = any worker
+        uint64_t affinityMask;
+        int lastWorker;
+
+        //cold fields: identity, callback and statistics
         string taskName;
-        Priority priority;
-        TaskState state;
         function<void()> taskCallback;
 
         mutex tcbMutex;
 
-        //waitTicks - the number of ticks this task has to wait to execute
-        //currentWaitTicks - the number of ticks that have passed
-        int waitTicks;
-        int currentWaitTicks;
-
         bool enableCountDownLogging;
         int timerActivations;
         chrono::steady_clock::time_point lastActivationTime;
         chrono::milliseconds totalWaitTIme;
-        bool timerPaused;
+        chrono::microseconds lastActivationInterval;
+
+        int deadlineMisses;
+        int worstLateness;
+
+        //longest measured callback run, and the budget declared up front for admission control
+        chrono::microseconds measuredExecutionTime;
+        chrono::microseconds executionBudget;
+
+        //kept out of line, the histograms are a few KB and only touched when recording
+        unique_ptr<TaskLatencyStats> latencyStats;
     
     public:
         TCB(const string& name, Priority priority, function<void()> callback, int waitPeriod = 0) : 
+                                                                                state(TaskState::READY),
+                                                                                priority(priority), 
+                                                                                timerPaused(false),
+                                                                                removalPending(false),
                                                                                 taskId(TaskManager::generateTaskId()) , 
+                                                                                waitTicks(waitPeriod),
+                                                                                pausedRemainingTicks(0),
+                                                                                expiryTick(0),
+                                                                                readyNext(nullptr),
+                                                                                readyPrev(nullptr),
+                                                                                readyLevel(-1),
+                                                                                timerLevel(-1),
+                                                                                timerSlot(0),
+                                                                                timerNext(nullptr),
+                                                                                timerPrev(nullptr),
+                                                                                heapIndex(-1),
+                                                                                heapSequence(0),
+                                                                                relativeDeadline(0),
+                                                                                releaseTick(0),
+                                                                                absoluteDeadline(0),
+                                                                                affinityMask(0),
+                                                                                lastWorker(-1),
                                                                                 taskName(name), 
-                                                                                priority(priority), 
-                                                                                state(TaskState::READY),
                                                                                 taskCallback(callback),
-                                                                                waitTicks(waitPeriod),
-                                                                                currentWaitTicks(0) {}
+                                                                                enableCountDownLogging(false),
+                                                                                timerActivations(0),
+                                                                                totalWaitTIme(0),
+                                                                                lastActivationInterval(0),
+                                                                                deadlineMisses(0),
+                                                                                worstLateness(0),
+                                                                                measuredExecutionTime(0),
+                                                                                executionBudget(0),
+                                                                                latencyStats(make_unique<TaskLatencyStats>()) {}
+
+        //moves an unqueued TCB into scheduler storage, the id moves with it and the mutex is fresh
+        TCB(TCB&& other) noexcept;
+        TCB(const TCB&) = delete;
+        TCB& operator = (const TCB&) = delete;
 
         uint32_t getId() const {return taskId;}
         const string& getName() const {return taskName;}
@@ -64,12 +162,15 @@ class TCB{
             waitTicks = ticks;
             return true;
         }
-        int getWaitTicks(){return waitTicks;}
-        void resetWaitTimers(){currentWaitTicks=0;}
-        bool incrementCurrentWaitTimer();
-        int getCurrentWaitTicks() const {return currentWaitTicks;}
-
-        bool isCountDownLoggingEnabled(){return enableCountDownLogging;}
+        int getWaitTicks() const {return waitTicks;}
+        //a period of 0 still waits for the next tick
+        int getEffectiveWaitTicks() const {return waitTicks > 0 ? waitTicks : 1;}
+        bool expireWaitTimer();
+        uint64_t getExpiryTick() const {return expiryTick;}
+        int getPausedRemainingTicks() const {return pausedRemainingTicks;}
+        void setPausedRemainingTicks(int ticks) {pausedRemainingTicks = ticks;}
+
+        bool isCountDownLoggingEnabled() const {return enableCountDownLogging;}
         void enableTimerCountdown(bool enable){enableCountDownLogging = enable;}
 
         int getTimerActivations() const {return timerActivations;}
@@ -80,7 +181,7 @@ class TCB{
         }
         void incrementActivation();
 
-        bool isTimerPaused(){
+        bool isTimerPaused() const {
             return timerPaused;
         }
         void pauseTimer(){
@@ -89,5 +190,52 @@ class TCB{
         void resumeTimer(){
             timerPaused = false;
         }
+
+        //set when unregistered while RUNNING, the scheduler drops it once the callback returns
+        bool isRemovalPending() const {return removalPending;}
+        void markRemovalPending(){removalPending = true;}
+
+        uint64_t getAffinityMask() const {return affinityMask;}
+        void setAffinityMask(uint64_t mask) {affinityMask = mask;}
+        int getLastWorker() const {return lastWorker;}
+        void setLastWorker(int workerIndex) {lastWorker = workerIndex;}
+
+        bool setRelativeDeadline(int ticks) {
+            if (ticks < 0) {
+                return false;
+            }
+            relativeDeadline = ticks;
+            return true;
+        }
+        int getRelativeDeadline() const {return relativeDeadline;}
+        int getEffectiveRelativeDeadline() const {return relativeDeadline > 0 ? relativeDeadline : getEffectiveWaitTicks();}
+        uint64_t getReleaseTick() const {return releaseTick;}
+        uint64_t getAbsoluteDeadline() const {return absoluteDeadline;}
+        void release(uint64_t tick) {
+            releaseTick = tick;
+            absoluteDeadline = tick + getEffectiveRelativeDeadline();
+            readySince = chrono::steady_clock::now();
+        }
+        //called when the callback is about to run, records release -> run latency
+        void recordRunStart();
+        //returns the lateness in ticks, > 0 means the deadline was missed
+        int recordCompletion(uint64_t tick);
+        int getDeadlineMisses() const {return deadlineMisses;}
+        int getWorstLateness() const {return worstLateness;}
+
+        void recordExecutionTime(chrono::microseconds duration) {
+            if (duration > measuredExecutionTime) {
+                measuredExecutionTime = duration;
+            }
+            latencyStats->runTime.record(static_cast<uint64_t>(duration.count()));
+        }
+        void setExecutionBudget(chrono::microseconds budget) {executionBudget = budget;}
+        chrono::microseconds getMeasuredExecutionTime() const {return measuredExecutionTime;}
+        chrono::microseconds getWorstCaseExecutionTime() const {
+            return measuredExecutionTime > executionBudget ? measuredExecutionTime : executionBudget;
+        }
+
+        //lock-free, may be called from any thread while the task is registered
+        TaskLatencySnapshot getLatencySnapshot() const;
         
 };
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "TCB.h"
+
+using namespace std;
+
+//binary min-heap of TCB pointers; each TCB remembers its slot so remove() is O(log n)
+//Compare(a, b) is true when a must run before b, ties fall back to enqueue order
+template<typename Compare>
+class TaskHeap{
+    private:
+        vector<TCB*> heap;
+        uint64_t nextSequence = 0;
+        Compare before;
+
+        bool precedes(const TCB* a, const TCB* b) const {
+            if (before(a, b)) {
+                return true;
+            }
+            if (before(b, a)) {
+                return false;
+            }
+            return a->heapSequence < b->heapSequence;
+        }
+
+        void place(size_t index, TCB* task){
+            heap[index] = task;
+            task->heapIndex = static_cast<int>(index);
+        }
+
+        void siftUp(size_t index){
+            TCB* task = heap[index];
+            while (index > 0) {
+                size_t parent = (index - 1) / 2;
+                if (!precedes(task, heap[parent])) {
+                    break;
+                }
+                place(index, heap[parent]);
+                index = parent;
+            }
+            place(index, task);
+        }
+
+        void siftDown(size_t index){
+            TCB* task = heap[index];
+            size_t count = heap.size();
+            while (true) {
+                size_t child = index * 2 + 1;
+                if (child >= count) {
+                    break;
+                }
+                if (child + 1 < count && precedes(heap[child + 1], heap[child])) {
+                    child++;
+                }
+                if (!precedes(heap[child], task)) {
+                    break;
+                }
+                place(index, heap[child]);
+                index = child;
+            }
+            place(index, task);
+        }
+
+    public:
+        bool push(TCB* task){
+            if (!task || task->heapIndex >= 0) {
+                return false;
+            }
+            task->heapSequence = nextSequence++;
+            heap.push_back(task);
+            siftUp(heap.size() - 1);
+            return true;
+        }
+
+        TCB* pop(){
+            if (heap.empty()) {
+                return nullptr;
+            }
+            TCB* top = heap.front();
+            remove(top);
+            return top;
+        }
+
+        bool remove(TCB* task){
+            if (!task || task->heapIndex < 0) {
+                return false;
+            }
+            size_t index = static_cast<size_t>(task->heapIndex);
+            TCB* last = heap.back();
+            heap.pop_back();
+            task->heapIndex = -1;
+            if (last != task) {
+                place(index, last);
+                siftDown(index);
+                siftUp(static_cast<size_t>(last->heapIndex));
+            }
+            return true;
+        }
+
+        bool empty() const {return heap.empty();}
+        size_t size() const {return heap.size();}
+
+        vector<TCB*> snapshot() const {
+            vector<TCB*> ordered(heap);
+            sort(ordered.begin(), ordered.end(), [this](const TCB* a, const TCB* b){ return precedes(a, b); });
+            return ordered;
+        }
+};
@@ -0,0 +1,90 @@
+#include "TaskTable.h"
+#include <new>
+
+using namespace std;
+
+TaskTable::TaskTable() : taskCount(0){}
+
+TaskTable::~TaskTable(){
+    clear();
+}
+
+TCB* TaskTable::insert(TCB&& task){
+    uint32_t taskId = task.getId();
+    if (nameIndex.find(task.getName()) != nameIndex.end()) {
+        return nullptr;
+    }
+    uint32_t pageIndex = taskId >> PAGE_BITS;
+    uint32_t slotIndex = taskId & SLOT_MASK;
+
+    if (pageIndex >= pages.size()) {
+        pages.resize(pageIndex + 1);
+    }
+    if (!pages[pageIndex]) {
+        pages[pageIndex] = make_unique<TaskPage>();
+    }
+    TaskPage& page = *pages[pageIndex];
+    if (page.occupiedMask & (uint64_t(1) << slotIndex)) {
+        return nullptr;
+    }
+
+    TCB* stored = new (page.storage[slotIndex]) TCB(std::move(task));
+    page.occupiedMask |= (uint64_t(1) << slotIndex);
+    nameIndex[stored->getName()] = taskId;
+    taskCount++;
+    return stored;
+}
+
+bool TaskTable::erase(uint32_t taskId){
+    TCB* task = findById(taskId);
+    if (!task) {
+        return false;
+    }
+    uint32_t pageIndex = taskId >> PAGE_BITS;
+    TaskPage& page = *pages[pageIndex];
+
+    nameIndex.erase(task->getName());
+    task->~TCB();
+    page.occupiedMask &= ~(uint64_t(1) << (taskId & SLOT_MASK));
+    taskCount--;
+
+    if (page.occupiedMask == 0) {
+        pages[pageIndex].reset();
+    }
+    return true;
+}
+
+void TaskTable::clear(){
+    for (auto& page : pages) {
+        if (!page) {
+            continue;
+        }
+        for (uint32_t index = 0; index < PAGE_SIZE; index++) {
+            if (page->occupiedMask & (uint64_t(1) << index)) {
+                page->slot(index)->~TCB();
+            }
+        }
+        page.reset();
+    }
+    pages.clear();
+    nameIndex.clear();
+    taskCount = 0;
+}
+
+TCB* TaskTable::findById(uint32_t taskId) const {
+    uint32_t pageIndex = taskId >> PAGE_BITS;
+    if (pageIndex >= pages.size() || !pages[pageIndex]) {
+        return nullptr;
+    }
+    TaskPage& page = *pages[pageIndex];
+    uint32_t slotIndex = taskId & SLOT_MASK;
+    if (!(page.occupiedMask & (uint64_t(1) << slotIndex))) {
+        return nullptr;
+    }
+    return page.slot(slotIndex);
+}
+
+TCB* TaskTable::findByName(const string& name) const {
+    auto it = nameIndex.find(name);
+    return it != nameIndex.end() ? findById(it->second) : nullptr;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TCB.h"
+
+using namespace std;
+
+//slab of TCBs indexed directly by task id: page = id / 64, slot = id % 64
+//TCBs are stored in place inside the pages, so they never move once registered
+//and walking the table is a linear scan over contiguous memory
+class TaskTable{
+    private:
+        static constexpr uint32_t PAGE_BITS = 6;
+        static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+        static constexpr uint32_t SLOT_MASK = PAGE_SIZE - 1;
+
+        struct TaskPage{
+            alignas(TCB) unsigned char storage[PAGE_SIZE][sizeof(TCB)];
+            uint64_t occupiedMask = 0;
+
+            TCB* slot(uint32_t index){return reinterpret_cast<TCB*>(storage[index]);}
+            const TCB* slot(uint32_t index) const {return reinterpret_cast<const TCB*>(storage[index]);}
+        };
+
+        vector<unique_ptr<TaskPage>> pages;
+        //side index for the name based (shell facing) APIs only
+        unordered_map<string, uint32_t> nameIndex;
+        size_t taskCount;
+
+    public:
+        TaskTable();
+        ~TaskTable();
+
+        TaskTable(const TaskTable&) = delete;
+        TaskTable& operator = (const TaskTable&) = delete;
+
+        //returns nullptr if the id or the name is already taken
+        TCB* insert(TCB&& task);
+        bool erase(uint32_t taskId);
+        void clear();
+
+        TCB* findById(uint32_t taskId) const;
+        TCB* findByName(const string& name) const;
+
+        size_t size() const {return taskCount;}
+        bool empty() const {return taskCount == 0;}
+
+        //visits tasks in id order
+        template<typename Visitor>
+        void forEach(Visitor visit) const {
+            for (const auto& page : pages) {
+                if (!page) {
+                    continue;
+                }
+                uint64_t occupied = page->occupiedMask;
+                for (uint32_t index = 0; occupied != 0; index++, occupied >>= 1) {
+                    if (occupied & 1) {
+                        visit(*const_cast<TCB*>(page->slot(index)));
+                    }
+                }
+            }
+        }
+};
@@ -0,0 +1,133 @@
+#include "TimerWheel.h"
+#include "TCB.h"
+
+using namespace std;
+
+TimerWheel::TimerWheel() : overflowList(nullptr), currentTick(0), armedCount(0){
+    for (int level = 0; level < LEVELS; level++) {
+        for (int slot = 0; slot < SLOTS_PER_LEVEL; slot++) {
+            slots[level][slot] = nullptr;
+        }
+    }
+}
+
+TCB*& TimerWheel::headFor(int level, int slot){
+    if (level == OVERFLOW_LEVEL) {
+        return overflowList;
+    }
+    return slots[level][slot];
+}
+
+//lowest level whose higher digits match the current tick, so the slot is reached before expiry
+void TimerWheel::insert(TCB* task){
+    uint64_t diff = task->expiryTick ^ currentTick;
+    int level = 0;
+    while (level < LEVELS && (diff >> (SLOT_BITS * (level + 1))) != 0) {
+        level++;
+    }
+    int slot = 0;
+    if (level < LEVELS) {
+        slot = static_cast<int>((task->expiryTick >> (SLOT_BITS * level)) & SLOT_MASK);
+    }
+
+    TCB*& head = headFor(level, slot);
+    task->timerPrev = nullptr;
+    task->timerNext = head;
+    if (head) {
+        head->timerPrev = task;
+    }
+    head = task;
+    task->timerLevel = level;
+    task->timerSlot = slot;
+}
+
+void TimerWheel::unlink(TCB* task){
+    TCB*& head = headFor(task->timerLevel, task->timerSlot);
+    if (task->timerPrev) {
+        task->timerPrev->timerNext = task->timerNext;
+    }
+    else{
+        head = task->timerNext;
+    }
+    if (task->timerNext) {
+        task->timerNext->timerPrev = task->timerPrev;
+    }
+    task->timerNext = nullptr;
+    task->timerPrev = nullptr;
+    task->timerLevel = -1;
+}
+
+bool TimerWheel::schedule(TCB* task, uint64_t expiryTick){
+    if (!task) {
+        return false;
+    }
+    if (task->timerLevel >= 0) {
+        unlink(task);
+        armedCount--;
+    }
+    task->expiryTick = expiryTick > currentTick ? expiryTick : currentTick + 1;
+    insert(task);
+    armedCount++;
+    return true;
+}
+
+bool TimerWheel::cancel(TCB* task){
+    if (!task || task->timerLevel < 0) {
+        return false;
+    }
+    unlink(task);
+    armedCount--;
+    return true;
+}
+
+bool TimerWheel::isArmed(const TCB* task) const {
+    return task && task->timerLevel >= 0;
+}
+
+void TimerWheel::cascade(TCB* list){
+    while (list) {
+        TCB* next = list->timerNext;
+        insert(list);
+        list = next;
+    }
+}
+
+TCB* TimerWheel::advance(){
+    currentTick++;
+
+    //pull timers down from the higher levels whose digit just rolled over, top first
+    if ((currentTick & ((uint64_t(1) << (SLOT_BITS * LEVELS)) - 1)) == 0) {
+        TCB* list = overflowList;
+        overflowList = nullptr;
+        cascade(list);
+    }
+    for (int level = LEVELS - 1; level >= 1; level--) {
+        if ((currentTick & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) != 0) {
+            continue;
+        }
+        int slot = static_cast<int>((currentTick >> (SLOT_BITS * level)) & SLOT_MASK);
+        TCB* list = slots[level][slot];
+        slots[level][slot] = nullptr;
+        cascade(list);
+    }
+
+    int slot = static_cast<int>(currentTick & SLOT_MASK);
+    TCB* task = slots[0][slot];
+    slots[0][slot] = nullptr;
+
+    TCB* expired = nullptr;
+    while (task) {
+        TCB* next = task->timerNext;
+        task->timerPrev = nullptr;
+        task->timerLevel = -1;
+        task->timerNext = expired;
+        expired = task;
+        armedCount--;
+        task = next;
+    }
+    return expired;
+}
+
+TCB* TimerWheel::nextExpired(const TCB* task){
+    return task ? task->timerNext : nullptr;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+class TCB;
+
+//hierarchical timing wheel keyed on absolute expiry ticks
+//4 levels x 64 slots cover 2^24 ticks, anything further out waits on an overflow list
+//ticks where nothing expires only look at one empty slot
+class TimerWheel{
+    private:
+        static constexpr int SLOT_BITS = 6;
+        static constexpr int SLOTS_PER_LEVEL = 1 << SLOT_BITS;
+        static constexpr uint64_t SLOT_MASK = SLOTS_PER_LEVEL - 1;
+        static constexpr int LEVELS = 4;
+        static constexpr int OVERFLOW_LEVEL = LEVELS;
+
+        TCB* slots[LEVELS][SLOTS_PER_LEVEL];
+        TCB* overflowList;
+        uint64_t currentTick;
+        size_t armedCount;
+
+        TCB*& headFor(int level, int slot);
+        void insert(TCB* task);
+        void unlink(TCB* task);
+        void cascade(TCB* list);
+
+    public:
+        TimerWheel();
+
+        //expiry ticks at or before the current tick fire on the next advance()
+        bool schedule(TCB* task, uint64_t expiryTick);
+        bool cancel(TCB* task);
+        bool isArmed(const TCB* task) const;
+
+        //moves the wheel one tick forward and returns the expired TCBs chained through timerNext
+        TCB* advance();
+        static TCB* nextExpired(const TCB* task);
+
+        uint64_t getCurrentTick() const {return currentTick;}
+        size_t size() const {return armedCount;}
+};
@@ -0,0 +1,64 @@
+#include "WorkStealingDeque.h"
+
+using namespace std;
+
+WorkStealingDeque::WorkStealingDeque() : top(0), bottom(0){
+    for (int64_t i = 0; i < CAPACITY; i++) {
+        buffer[i].store(nullptr, memory_order_relaxed);
+    }
+}
+
+bool WorkStealingDeque::push(TCB* task){
+    int64_t b = bottom.load(memory_order_relaxed);
+    int64_t t = top.load(memory_order_acquire);
+    if (b - t >= CAPACITY) {
+        return false;
+    }
+    buffer[b & INDEX_MASK].store(task, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    bottom.store(b + 1, memory_order_relaxed);
+    return true;
+}
+
+TCB* WorkStealingDeque::pop(){
+    int64_t b = bottom.load(memory_order_relaxed) - 1;
+    bottom.store(b, memory_order_relaxed);
+    //the bottom claim has to be visible before top is read, or a thief and the owner could both take the last task
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = top.load(memory_order_relaxed);
+    if (t > b) {
+        bottom.store(b + 1, memory_order_relaxed);
+        return nullptr;
+    }
+    TCB* task = buffer[b & INDEX_MASK].load(memory_order_relaxed);
+    if (t == b) {
+        //last element, settle it with the thieves through top
+        if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            task = nullptr;
+        }
+        bottom.store(b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+TCB* WorkStealingDeque::steal(bool& lostRace){
+    lostRace = false;
+    int64_t t = top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = bottom.load(memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+    TCB* task = buffer[t & INDEX_MASK].load(memory_order_acquire);
+    if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        lostRace = true;
+        return nullptr;
+    }
+    return task;
+}
+
+size_t WorkStealingDeque::size() const {
+    int64_t b = bottom.load(memory_order_relaxed);
+    int64_t t = top.load(memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+}
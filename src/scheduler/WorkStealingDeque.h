@@ -0,0 +1,32 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+class TCB;
+
+//Chase-Lev deque: the owning worker pushes and pops at the bottom (LIFO, no CAS unless it races a
+//thief for the last element), thieves take from the top
+class WorkStealingDeque{
+    private:
+        static constexpr int64_t CAPACITY = 1024;
+        static constexpr int64_t INDEX_MASK = CAPACITY - 1;
+
+        atomic<int64_t> top;
+        atomic<int64_t> bottom;
+        atomic<TCB*> buffer[CAPACITY];
+
+    public:
+        WorkStealingDeque();
+
+        //owner only
+        bool push(TCB* task);
+        TCB* pop();
+
+        //any thread; lostRace is set when another thread won the race for the top element
+        TCB* steal(bool& lostRace);
+
+        size_t size() const;
+};
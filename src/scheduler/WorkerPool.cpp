@@ -0,0 +1,224 @@
+#include "WorkerPool.h"
+#include "TCB.h"
+#include <chrono>
+#include <mutex>
+
+using namespace std;
+
+WorkerPool::WorkerPool(unsigned workerCount, TaskRunner taskRunner) : runner(std::move(taskRunner)),
+                                                                      nextWorker(0),
+                                                                      pendingTasks(0),
+                                                                      stopping(false),
+                                                                      workEpoch(0){
+    if (workerCount == 0) {
+        workerCount = 1;
+    }
+    if (workerCount > MAX_WORKERS) {
+        workerCount = MAX_WORKERS;
+    }
+    allWorkersMask = workerCount == 64 ? ~uint64_t(0) : ((uint64_t(1) << workerCount) - 1);
+
+    for (unsigned i = 0; i < workerCount; i++) {
+        workers.push_back(make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < workerCount; i++) {
+        workers[i]->workerThread = thread(&WorkerPool::workerLoop, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool(){
+    stop();
+}
+
+//stay on the worker that ran the task last while it is idle, otherwise round-robin over the allowed set
+unsigned WorkerPool::pickWorker(const TCB* task, uint64_t allowedMask){
+    int lastWorker = task->getLastWorker();
+    if (lastWorker >= 0 && (allowedMask & (uint64_t(1) << lastWorker)) && !workers[lastWorker]->busy) {
+        return static_cast<unsigned>(lastWorker);
+    }
+    unsigned count = getWorkerCount();
+    for (unsigned i = 0; i < count; i++) {
+        unsigned candidate = (nextWorker + i) % count;
+        if ((allowedMask & (uint64_t(1) << candidate)) && !workers[candidate]->busy) {
+            nextWorker = (candidate + 1) % count;
+            return candidate;
+        }
+    }
+    for (unsigned i = 0; i < count; i++) {
+        unsigned candidate = (nextWorker + i) % count;
+        if (allowedMask & (uint64_t(1) << candidate)) {
+            nextWorker = (candidate + 1) % count;
+            return candidate;
+        }
+    }
+    return 0;
+}
+
+bool WorkerPool::submit(TCB* task){
+    if (stopping || !task) {
+        return false;
+    }
+    uint64_t allowedMask = task->getAffinityMask() & allWorkersMask;
+    if (allowedMask == 0) {
+        allowedMask = allWorkersMask;
+    }
+    unsigned target = pickWorker(task, allowedMask);
+    if (!workers[target]->inbox.push({task, allowedMask != allWorkersMask})) {
+        return false;
+    }
+    pendingTasks++;
+    workEpoch++;
+    wakeWorker(*workers[target]);
+    return true;
+}
+
+//lock-free unless the worker is parked: it publishes sleeping before its last look for work, so
+//either it sees this submit's epoch or this sees it sleeping (both sides are seq_cst)
+void WorkerPool::wakeWorker(Worker& worker){
+    if (!worker.sleeping) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(worker.wakeMutex);
+        worker.wakeSignal = true;
+    }
+    worker.wakeCondition.notify_one();
+}
+
+void WorkerPool::wakeIdleWorker(unsigned except){
+    unsigned count = getWorkerCount();
+    for (unsigned i = 1; i < count; i++) {
+        Worker& worker = *workers[(except + i) % count];
+        if (worker.sleeping) {
+            wakeWorker(worker);
+            return;
+        }
+    }
+}
+
+void WorkerPool::stop(){
+    stopping = true;
+    workEpoch++;
+    for (auto& worker : workers) {
+        {
+            lock_guard<mutex> lock(worker->wakeMutex);
+            worker->wakeSignal = true;
+        }
+        worker->wakeCondition.notify_one();
+    }
+    for (auto& worker : workers) {
+        if (worker->workerThread.joinable()) {
+            worker->workerThread.join();
+        }
+    }
+}
+
+vector<WorkerStats> WorkerPool::getWorkerStats() const {
+    vector<WorkerStats> stats;
+    for (unsigned i = 0; i < getWorkerCount(); i++) {
+        const Worker& worker = *workers[i];
+        stats.push_back({i,
+                         worker.tasksExecuted.load(),
+                         worker.steals.load(),
+                         worker.failedSteals.load(),
+                         worker.idleWaits.load(),
+                         worker.runQueue.size()});
+    }
+    return stats;
+}
+
+//the run queue is popped newest first, so each drained batch goes in back to front and the owner
+//still runs it in dispatch (priority) order; thieves get the batch's tail
+void WorkerPool::drainInbox(Worker& worker){
+    Submission submission{nullptr, false};
+    worker.drained.clear();
+    while (worker.inbox.pop(submission)) {
+        if (submission.pinned) {
+            worker.pinnedTasks.push_back(submission.task);
+        }
+        else{
+            worker.drained.push_back(submission.task);
+        }
+    }
+    for (auto it = worker.drained.rbegin(); it != worker.drained.rend(); ++it) {
+        if (!worker.runQueue.push(*it)) {
+            worker.pinnedTasks.push_back(*it);
+        }
+    }
+}
+
+TCB* WorkerPool::stealWork(unsigned workerIndex){
+    Worker& self = *workers[workerIndex];
+    unsigned count = getWorkerCount();
+    for (unsigned i = 1; i < count; i++) {
+        Worker& victim = *workers[(workerIndex + i) % count];
+        bool lostRace = false;
+        TCB* task = victim.runQueue.steal(lostRace);
+        if (task) {
+            self.steals++;
+            return task;
+        }
+        if (lostRace) {
+            self.failedSteals++;
+        }
+    }
+    return nullptr;
+}
+
+TCB* WorkerPool::findWork(unsigned workerIndex){
+    Worker& self = *workers[workerIndex];
+    drainInbox(self);
+    if (!self.pinnedTasks.empty()) {
+        TCB* task = self.pinnedTasks.front();
+        self.pinnedTasks.pop_front();
+        return task;
+    }
+    TCB* task = self.runQueue.pop();
+    if (task) {
+        return task;
+    }
+    return stealWork(workerIndex);
+}
+
+void WorkerPool::workerLoop(unsigned workerIndex){
+    Worker& self = *workers[workerIndex];
+    self.drained.reserve(1024);
+    while (true) {
+        uint64_t observedEpoch = workEpoch;
+
+        TCB* task = findWork(workerIndex);
+        if (task) {
+            self.busy = true;
+            //the last task out during stop() releases the workers parked waiting for it
+            if (--pendingTasks == 0 && stopping) {
+                for (auto& worker : workers) {
+                    wakeWorker(*worker);
+                }
+            }
+            //more queued behind this one, hand it to an idle worker rather than let it wait
+            if (self.runQueue.size() > 0) {
+                wakeIdleWorker(workerIndex);
+            }
+            task->setLastWorker(static_cast<int>(workerIndex));
+            runner(task, workerIndex);
+            self.tasksExecuted++;
+            self.busy = false;
+            continue;
+        }
+
+        if (stopping && pendingTasks == 0) {
+            return;
+        }
+        self.idleWaits++;
+        self.sleeping = true;
+        //last look after announcing the sleep, anything submitted from here on signals us
+        if (workEpoch == observedEpoch && !(stopping && pendingTasks == 0)) {
+            unique_lock<mutex> lock(self.wakeMutex);
+            self.wakeCondition.wait(lock, [&self](){
+                return self.wakeSignal;
+            });
+            self.wakeSignal = false;
+        }
+        self.sleeping = false;
+    }
+}
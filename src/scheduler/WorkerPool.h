@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SpscRing.h"
+#include "WorkStealingDeque.h"
+
+using namespace std;
+
+class TCB;
+
+struct WorkerStats{
+    unsigned workerIndex;
+    uint64_t tasksExecuted;
+    uint64_t steals;
+    uint64_t failedSteals;
+    uint64_t idleWaits;
+    size_t queuedTasks;
+};
+
+//worker threads with per-worker run queues:
+//- inbox: SPSC ring filled by the dispatching thread
+//- runQueue: Chase-Lev deque, the owner pops its newest end and idle workers steal the oldest
+//- pinnedTasks: tasks whose affinity excludes some workers, never stolen
+//each worker parks on its own condition variable; submit() wakes only the worker it queued to, and a
+//worker that finds more in its run queue than the task it took wakes one parked thief
+class WorkerPool{
+    public:
+        using TaskRunner = function<void(TCB* task, unsigned workerIndex)>;
+        static constexpr unsigned MAX_WORKERS = 64;
+
+    private:
+        struct Submission{
+            TCB* task;
+            bool pinned;
+        };
+
+        struct Worker{
+            SpscRing<Submission, 1024> inbox;
+            WorkStealingDeque runQueue;
+            deque<TCB*> pinnedTasks;
+            thread workerThread;
+            atomic<bool> busy{false};
+            //set before the worker re-checks for work and parks, see wakeWorker()
+            atomic<bool> sleeping{false};
+            mutex wakeMutex;
+            condition_variable wakeCondition;
+            bool wakeSignal = false;
+            //inbox drain scratch, reused so draining doesn't allocate
+            vector<TCB*> drained;
+            atomic<uint64_t> tasksExecuted{0};
+            atomic<uint64_t> steals{0};
+            atomic<uint64_t> failedSteals{0};
+            atomic<uint64_t> idleWaits{0};
+        };
+
+        vector<unique_ptr<Worker>> workers;
+        TaskRunner runner;
+        uint64_t allWorkersMask;
+        unsigned nextWorker;
+
+        atomic<unsigned> pendingTasks;
+        atomic<bool> stopping;
+
+        //bumped by every submit, a worker about to park re-reads it to catch work queued meanwhile
+        atomic<uint64_t> workEpoch;
+
+        void workerLoop(unsigned workerIndex);
+        void wakeWorker(Worker& worker);
+        //wakes one parked worker other than except, so stealable work doesn't wait for its owner
+        void wakeIdleWorker(unsigned except);
+        void drainInbox(Worker& worker);
+        TCB* findWork(unsigned workerIndex);
+        TCB* stealWork(unsigned workerIndex);
+        unsigned pickWorker(const TCB* task, uint64_t allowedMask);
+
+    public:
+        WorkerPool(unsigned workerCount, TaskRunner taskRunner);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator = (const WorkerPool&) = delete;
+
+        //called by one dispatching thread at a time (the scheduler holds schedulerMutex)
+        bool submit(TCB* task);
+        //runs everything already submitted, then joins the workers
+        void stop();
+
+        unsigned getWorkerCount() const {return static_cast<unsigned>(workers.size());}
+        vector<WorkerStats> getWorkerStats() const;
+};
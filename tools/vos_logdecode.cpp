@@ -0,0 +1,119 @@
+//offline decoder for the binary log written by Logger::enableBinaryLog
+//usage: vos_logdecode <file.vlog>   - prints the same text the console logger would
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "kernel/BinaryLogFormat.h"
+#include "kernel/LogFormat.h"
+
+using namespace std;
+
+static bool decodeArguments(const unsigned char* payload, size_t length, uint16_t argumentCount, vector<string>& arguments){
+    size_t offset = 0;
+    for (uint16_t index = 0; index < argumentCount; index++) {
+        if (offset >= length) {
+            return false;
+        }
+        auto type = static_cast<BinaryLog::ArgumentType>(payload[offset++]);
+        if (type == BinaryLog::ArgumentType::STR) {
+            if (offset >= length || offset + 1 + payload[offset] > length) {
+                return false;
+            }
+            size_t textLength = payload[offset++];
+            arguments.emplace_back(reinterpret_cast<const char*>(payload + offset), textLength);
+            offset += textLength;
+            continue;
+        }
+        if (offset + 8 > length) {
+            return false;
+        }
+        if (type == BinaryLog::ArgumentType::I64) {
+            int64_t value;
+            memcpy(&value, payload + offset, sizeof(value));
+            arguments.push_back(to_string(value));
+        }
+        else if (type == BinaryLog::ArgumentType::U64) {
+            uint64_t value;
+            memcpy(&value, payload + offset, sizeof(value));
+            arguments.push_back(to_string(value));
+        }
+        else if (type == BinaryLog::ArgumentType::F64) {
+            double value;
+            memcpy(&value, payload + offset, sizeof(value));
+            arguments.push_back(to_string(value));
+        }
+        else{
+            return false;
+        }
+        offset += 8;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    if (argc != 2) {
+        cerr << "usage: " << argv[0] << " <binary log file>" << endl;
+        return 2;
+    }
+    ifstream input(argv[1], ios::binary);
+    if (!input) {
+        cerr << "cannot open " << argv[1] << endl;
+        return 1;
+    }
+    vector<unsigned char> contents((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+
+    BinaryLog::FileHeader fileHeader;
+    if (contents.size() < sizeof(fileHeader)) {
+        cerr << "file too small for a binary log header" << endl;
+        return 1;
+    }
+    memcpy(&fileHeader, contents.data(), sizeof(fileHeader));
+    if (memcmp(fileHeader.magic, BinaryLog::MAGIC, sizeof(fileHeader.magic)) != 0 || fileHeader.version != BinaryLog::VERSION) {
+        cerr << "not a vOS binary log (or unsupported version)" << endl;
+        return 1;
+    }
+
+    //usedBytes is 0 when the log was not closed cleanly, then read until the zero filled tail
+    size_t end = contents.size();
+    if (fileHeader.usedBytes > 0 && fileHeader.headerSize + fileHeader.usedBytes < end) {
+        end = fileHeader.headerSize + fileHeader.usedBytes;
+    }
+
+    unordered_map<uint16_t, string> formats;
+    size_t offset = fileHeader.headerSize;
+    size_t decoded = 0;
+    while (offset + sizeof(BinaryLog::EntryHeader) <= end) {
+        BinaryLog::EntryHeader entryHeader;
+        memcpy(&entryHeader, contents.data() + offset, sizeof(entryHeader));
+        if (entryHeader.size < sizeof(entryHeader) || offset + entryHeader.size > end) {
+            break;
+        }
+        const unsigned char* payload = contents.data() + offset + sizeof(entryHeader);
+        size_t payloadLength = entryHeader.size - sizeof(entryHeader);
+
+        if (entryHeader.kind == BinaryLog::EntryKind::FORMAT_DEFINITION) {
+            formats[entryHeader.formatId] = string(reinterpret_cast<const char*>(payload), payloadLength);
+        }
+        else if (entryHeader.kind == BinaryLog::EntryKind::EVENT) {
+            auto format = formats.find(entryHeader.formatId);
+            vector<string> arguments;
+            if (format == formats.end() || !decodeArguments(payload, payloadLength, entryHeader.argCount, arguments)) {
+                cerr << "undecodable entry at offset " << offset << " (format " << entryHeader.formatId << ")" << endl;
+            }
+            else{
+                string message = BinaryLog::substituteArguments(format->second, arguments.data(), arguments.size());
+                cout << formatLogMessage(static_cast<MessageType>(entryHeader.messageType), message, entryHeader.tick) << '\n';
+                decoded++;
+            }
+        }
+        offset += entryHeader.size;
+    }
+    cerr << decoded << " entries decoded" << endl;
+    return 0;
+}
@@ -0,0 +1,118 @@
+//VFS throughput benchmark: aggregate descriptor reads per second as I/O threads are added
+//usage: vos_vfsbench [devices=8] [transfer-us=200] [run-ms=1000]
+//every simulated device spends transfer-us per read, like a driver waiting on the bus;
+//"own device" gives each thread its own device, "shared device" puts every thread on /dev/bench0
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "kernel/Kernel.h"
+#include "kernel/Device.h"
+
+using namespace std;
+
+class SimulatedDevice : public Device {
+    public:
+        SimulatedDevice(const string& name, chrono::microseconds transferTime) : transferTime(transferTime) {
+            deviceName = name;
+            deviceType = "bench";
+        }
+        int read(void* buffer, size_t size) override {
+            (void)buffer;
+            this_thread::sleep_for(transferTime);
+            return static_cast<int>(size);
+        }
+        int write(const void* buffer, size_t size) override {
+            (void)buffer;
+            this_thread::sleep_for(transferTime);
+            return static_cast<int>(size);
+        }
+        string getName() const override {return deviceName;}
+        bool isReady() const override {return true;}
+        string getType() const override {return deviceType;}
+        string getStatus() const override {return "ready";}
+        bool configure(int parameter, int value) override {(void)parameter; (void)value; return true;}
+        bool initialise() override {return true;}
+        void cleanup() override {}
+
+    private:
+        chrono::microseconds transferTime;
+};
+
+//runs threads readers for runTime, reader i uses /dev/bench<i % devices>; returns total reads
+static uint64_t runReaders(VirtualFileSystem& vfs, int threads, int devices, chrono::milliseconds runTime){
+    atomic<uint64_t> operations(0);
+    atomic<bool> stop(false);
+    vector<thread> readers;
+    for (int index = 0; index < threads; index++) {
+        readers.emplace_back([&, index]{
+            int fd = vfs.openDevice("/dev/bench" + to_string(index % devices));
+            if (fd < 0) {
+                return;
+            }
+            char buffer[16];
+            uint64_t local = 0;
+            while (!stop.load(memory_order_relaxed)) {
+                if (vfs.read(fd, buffer, sizeof(buffer)) > 0) {
+                    local++;
+                }
+            }
+            operations.fetch_add(local);
+            vfs.close(fd);
+        });
+    }
+    this_thread::sleep_for(runTime);
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    return operations.load();
+}
+
+int main(int argc, char* argv[]){
+    int devices = argc > 1 ? atoi(argv[1]) : 8;
+    int transferMicros = argc > 2 ? atoi(argv[2]) : 200;
+    int runMillis = argc > 3 ? atoi(argv[3]) : 1000;
+    if (devices <= 0 || transferMicros < 0 || runMillis <= 0) {
+        cerr << "usage: vos_vfsbench [devices=8] [transfer-us=200] [run-ms=1000]" << endl;
+        return 1;
+    }
+
+    auto& kernel = Kernel::getInstance();
+    Logger& logger = kernel.getLogger();
+    logger.initialize();
+    logger.setMessageTypeEnabled(MessageType::VFS, false);
+    VirtualFileSystem& vfs = kernel.getVfs();
+    vfs.initialize();
+    for (int index = 0; index < devices; index++) {
+        string name = "bench" + to_string(index);
+        vfs.registerDevice("/dev/" + name, make_unique<SimulatedDevice>(name, chrono::microseconds(transferMicros)));
+    }
+
+    chrono::milliseconds runTime(runMillis);
+    cout << devices << " devices, " << transferMicros << "us per read, " << runMillis << "ms per run, "
+         << thread::hardware_concurrency() << " hardware threads" << endl;
+    cout << setw(8) << "threads" << setw(20) << "own device ops/s" << setw(10) << "speedup"
+         << setw(22) << "shared device ops/s" << endl;
+    double baseline = 0;
+    for (int threads = 1; threads <= devices; threads *= 2) {
+        double seconds = runMillis / 1000.0;
+        double own = runReaders(vfs, threads, devices, runTime) / seconds;
+        double shared = runReaders(vfs, threads, 1, runTime) / seconds;
+        if (threads == 1) {
+            baseline = own;
+        }
+        cout << setw(8) << threads << setw(20) << fixed << setprecision(0) << own
+             << setw(9) << setprecision(2) << (baseline > 0 ? own / baseline : 0) << "x"
+             << setw(22) << setprecision(0) << shared << endl;
+    }
+
+    vfs.cleanup();
+    logger.stop();
+    return 0;
+}